@@ -0,0 +1,441 @@
+// Gateway central for I2C scanner nodes
+//
+// Connects to every node advertising the scanner service, up to
+// CONFIG_BT_MAX_CONN at once, subscribes to their scan results and merges
+// them into one line-oriented stream on the console UART:
+//
+//   RESULT,<node>,<bt addr>,<uptime us>,<latency us>,<count>,<flags>,<addr>;...
+//   READ,<node>,<uptime us>,<count>,<flags>
+//   STATS,<uptime us>,<nodes>,<results>,<bytes>,<bytes/s>
+//
+// The latency is the arrival time minus the sweep completion time carried in
+// the result; it is only meaningful where both clocks are the same, as under
+// BabbleSim. After subscribing, the result characteristic is also read once
+// (READ line), so the GATT read path is exercised as well as notifications.
+//
+// Each connection gets a slightly different interval so the connection
+// events of many nodes drift past each other instead of colliding at the
+// same anchor points. Connection setup, reconnect time and arrival times are
+// logged in microseconds of uptime; under BabbleSim all devices share the
+// simulated clock, so they compare directly with the scanners' log
+// timestamps.
+
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+#include <zephyr/bluetooth/bluetooth.h>
+#include <zephyr/bluetooth/conn.h>
+#include <zephyr/bluetooth/gatt.h>
+#include <zephyr/bluetooth/uuid.h>
+#include <zephyr/sys/byteorder.h>
+#include <stddef.h>
+#include <string.h>
+
+#include "scan_result.h"
+
+LOG_MODULE_REGISTER(i2c_scanner_gateway, LOG_LEVEL_INF);
+
+// Longest RESULT line: fixed fields plus "XX;" per address
+#define RESULT_LINE_LEN (80 + BT_ADDR_LE_STR_LEN + 3 * SCAN_RESULT_MAX_ADDRS)
+
+static const struct bt_uuid_128 scanner_service_uuid =
+	BT_UUID_INIT_128(BT_UUID_I2C_SCANNER_SERVICE_VAL);
+static const struct bt_uuid_128 scan_result_uuid =
+	BT_UUID_INIT_128(BT_UUID_I2C_SCAN_RESULT_VAL);
+
+struct scanner_node {
+	struct bt_conn *conn;
+	bt_addr_le_t addr;
+	struct bt_gatt_discover_params discover_params;
+	struct bt_gatt_subscribe_params subscribe_params;
+	struct bt_gatt_read_params read_params;
+	int64_t found_us;
+	int64_t disconnected_us;    // -1 until the first drop
+	int64_t last_result_us;
+	uint32_t results;
+};
+
+static struct scanner_node nodes[CONFIG_BT_MAX_CONN];
+// Node with a connection being created, only one may be pending
+static struct scanner_node *connecting;
+
+// Totals over all nodes since the last STATS line
+static uint32_t total_results;
+static uint32_t total_bytes;
+static int64_t stats_start_us;
+
+static int64_t now_us(void)
+{
+	return k_ticks_to_us_floor64(k_uptime_ticks());
+}
+
+static struct scanner_node *node_by_conn(struct bt_conn *conn)
+{
+	for (int i = 0; i < ARRAY_SIZE(nodes); i++) {
+		if (nodes[i].conn == conn) {
+			return &nodes[i];
+		}
+	}
+	return NULL;
+}
+
+static struct scanner_node *node_by_addr(const bt_addr_le_t *addr)
+{
+	for (int i = 0; i < ARRAY_SIZE(nodes); i++) {
+		if (bt_addr_le_eq(&nodes[i].addr, addr)) {
+			return &nodes[i];
+		}
+	}
+	return NULL;
+}
+
+static int num_connected(void)
+{
+	int count = 0;
+
+	for (int i = 0; i < ARRAY_SIZE(nodes); i++) {
+		if (nodes[i].conn != NULL && &nodes[i] != connecting) {
+			count++;
+		}
+	}
+	return count;
+}
+
+/**
+ * @brief Find the slot for a node, preferring the one it had before
+ * @return Free slot, or NULL if all slots are in use
+ */
+static struct scanner_node *node_slot(const bt_addr_le_t *addr)
+{
+	struct scanner_node *node = node_by_addr(addr);
+
+	if (node != NULL) {
+		return node->conn == NULL ? node : NULL;
+	}
+
+	for (int i = 0; i < ARRAY_SIZE(nodes); i++) {
+		if (nodes[i].conn == NULL && bt_addr_le_eq(&nodes[i].addr, BT_ADDR_LE_ANY)) {
+			bt_addr_le_copy(&nodes[i].addr, addr);
+			nodes[i].disconnected_us = -1;
+			return &nodes[i];
+		}
+	}
+
+	// Reuse the slot of a node that has gone away
+	for (int i = 0; i < ARRAY_SIZE(nodes); i++) {
+		if (nodes[i].conn == NULL) {
+			bt_addr_le_copy(&nodes[i].addr, addr);
+			nodes[i].disconnected_us = -1;
+			return &nodes[i];
+		}
+	}
+
+	return NULL;
+}
+
+static void start_scan(void);
+
+static void stats_work_handler(struct k_work *work)
+{
+	int64_t t = now_us();
+	int64_t elapsed_us = t - stats_start_us;
+
+	printk("STATS,%lld,%d,%u,%u,%lld\n", t, num_connected(), total_results,
+	       total_bytes,
+	       elapsed_us ? (int64_t)total_bytes * USEC_PER_SEC / elapsed_us : 0);
+
+	total_results = 0;
+	total_bytes = 0;
+	stats_start_us = t;
+	k_work_schedule(k_work_delayable_from_work(work),
+			K_MSEC(CONFIG_CENTRAL_STATS_PERIOD_MS));
+}
+
+static K_WORK_DELAYABLE_DEFINE(stats_work, stats_work_handler);
+
+static uint8_t on_scan_result(struct bt_conn *conn,
+			      struct bt_gatt_subscribe_params *params,
+			      const void *data, uint16_t length)
+{
+	struct scanner_node *node = CONTAINER_OF(params, struct scanner_node,
+						 subscribe_params);
+	struct i2c_scan_result res = { 0 };
+	char addr_str[BT_ADDR_LE_STR_LEN];
+	char line[RESULT_LINE_LEN];
+	int64_t t = now_us();
+	int64_t latency_us = -1;
+	int pos;
+
+	if (data == NULL) {
+		params->value_handle = 0;
+		return BT_GATT_ITER_STOP;
+	}
+
+	node->results++;
+	total_results++;
+	total_bytes += length;
+
+	// Older scanners send a shorter result, the missing fields stay zero
+	memcpy(&res, data, MIN(length, sizeof(res)));
+	if (length >= offsetof(struct i2c_scan_result, complete_us) +
+		      sizeof(res.complete_us)) {
+		// The completion time holds the low 32 bits of the scanner's
+		// uptime in microseconds
+		latency_us = (uint32_t)((uint32_t)t - sys_le32_to_cpu(res.complete_us));
+	}
+
+	// Build the whole line first so lines from different nodes and the
+	// STATS line never interleave
+	bt_addr_le_to_str(&node->addr, addr_str, sizeof(addr_str));
+	pos = snprintk(line, sizeof(line), "RESULT,%d,%s,%lld,%lld,%u,%u,",
+		       (int)(node - nodes), addr_str, t, latency_us, res.device_count,
+		       res.flags);
+	for (int i = 0; i < MIN(res.device_count, SCAN_RESULT_MAX_ADDRS); i++) {
+		pos += snprintk(&line[pos], sizeof(line) - pos, "%s%02X", i ? ";" : "",
+				res.addresses[i]);
+	}
+	printk("%s\n", line);
+
+	LOG_DBG("Node %d: %lld us since previous result", (int)(node - nodes),
+		node->last_result_us ? t - node->last_result_us : 0);
+	node->last_result_us = t;
+
+	if (CONFIG_CENTRAL_RECONNECT_AFTER > 0 &&
+	    (node->results % CONFIG_CENTRAL_RECONNECT_AFTER) == 0) {
+		bt_conn_disconnect(conn, BT_HCI_ERR_REMOTE_USER_TERM_CONN);
+		return BT_GATT_ITER_STOP;
+	}
+
+	return BT_GATT_ITER_CONTINUE;
+}
+
+static uint8_t on_read(struct bt_conn *conn, uint8_t err,
+		       struct bt_gatt_read_params *params, const void *data,
+		       uint16_t length)
+{
+	struct scanner_node *node = CONTAINER_OF(params, struct scanner_node,
+						 read_params);
+	struct i2c_scan_result res = { 0 };
+
+	if (err) {
+		LOG_ERR("Node %d: scan result read failed (err 0x%02x)",
+			(int)(node - nodes), err);
+		return BT_GATT_ITER_STOP;
+	}
+
+	if (data == NULL) {
+		return BT_GATT_ITER_STOP;
+	}
+
+	memcpy(&res, data, MIN(length, sizeof(res)));
+	printk("READ,%d,%lld,%u,%u\n", (int)(node - nodes), now_us(),
+	       res.device_count, res.flags);
+	return BT_GATT_ITER_STOP;
+}
+
+static uint8_t on_discover(struct bt_conn *conn, const struct bt_gatt_attr *attr,
+			   struct bt_gatt_discover_params *params)
+{
+	struct scanner_node *node = CONTAINER_OF(params, struct scanner_node,
+						 discover_params);
+	const struct bt_gatt_chrc *chrc;
+	int err;
+
+	if (attr == NULL) {
+		LOG_ERR("Node %d: scan result characteristic not found",
+			(int)(node - nodes));
+		return BT_GATT_ITER_STOP;
+	}
+
+	chrc = attr->user_data;
+
+	// The CCC descriptor directly follows the value in the scanner service
+	node->subscribe_params.notify = on_scan_result;
+	node->subscribe_params.value = BT_GATT_CCC_NOTIFY;
+	node->subscribe_params.value_handle = chrc->value_handle;
+	node->subscribe_params.ccc_handle = chrc->value_handle + 1;
+
+	err = bt_gatt_subscribe(conn, &node->subscribe_params);
+	if (err && err != -EALREADY) {
+		LOG_ERR("Node %d: subscribe failed (err %d)", (int)(node - nodes), err);
+		return BT_GATT_ITER_STOP;
+	}
+
+	LOG_INF("Node %d subscribed %lld us after its advertisement was seen",
+		(int)(node - nodes), now_us() - node->found_us);
+
+	// Read the current result once, notifications only cover new sweeps
+	node->read_params.func = on_read;
+	node->read_params.handle_count = 1;
+	node->read_params.single.handle = chrc->value_handle;
+	node->read_params.single.offset = 0;
+
+	err = bt_gatt_read(conn, &node->read_params);
+	if (err) {
+		LOG_ERR("Node %d: read failed (err %d)", (int)(node - nodes), err);
+	}
+
+	return BT_GATT_ITER_STOP;
+}
+
+static bool ad_has_scanner_uuid(struct bt_data *data, void *user_data)
+{
+	bool *found = user_data;
+
+	if (data->type == BT_DATA_UUID128_ALL || data->type == BT_DATA_UUID128_SOME) {
+		for (size_t i = 0; i + BT_UUID_SIZE_128 <= data->data_len;
+		     i += BT_UUID_SIZE_128) {
+			if (memcmp(&data->data[i], scanner_service_uuid.val,
+				   BT_UUID_SIZE_128) == 0) {
+				*found = true;
+				return false;
+			}
+		}
+	}
+
+	return true;
+}
+
+static void device_found(const bt_addr_le_t *addr, int8_t rssi, uint8_t type,
+			 struct net_buf_simple *ad)
+{
+	struct bt_le_conn_param param;
+	struct scanner_node *node;
+	bool found = false;
+	uint16_t interval;
+	int err;
+
+	if (connecting != NULL ||
+	    (type != BT_GAP_ADV_TYPE_ADV_IND && type != BT_GAP_ADV_TYPE_ADV_DIRECT_IND)) {
+		return;
+	}
+
+	bt_data_parse(ad, ad_has_scanner_uuid, &found);
+	if (!found) {
+		return;
+	}
+
+	node = node_slot(addr);
+	if (node == NULL) {
+		return;
+	}
+
+	if (bt_le_scan_stop()) {
+		return;
+	}
+
+	// Stagger the intervals by slot, in 1.25 ms units
+	interval = CONFIG_CENTRAL_CONN_INTERVAL +
+		   (node - nodes) * CONFIG_CENTRAL_CONN_INTERVAL_STEP;
+	param = (struct bt_le_conn_param)BT_LE_CONN_PARAM_INIT(interval, interval, 0,
+								CONFIG_CENTRAL_SUPERVISION_TIMEOUT);
+
+	node->found_us = now_us();
+	err = bt_conn_le_create(addr, BT_CONN_LE_CREATE_CONN, &param, &node->conn);
+	if (err) {
+		LOG_ERR("Create connection failed (err %d)", err);
+		node->conn = NULL;
+		start_scan();
+		return;
+	}
+
+	connecting = node;
+}
+
+static void start_scan(void)
+{
+	int err;
+
+	if (connecting != NULL || num_connected() >= ARRAY_SIZE(nodes)) {
+		return;
+	}
+
+	err = bt_le_scan_start(BT_LE_SCAN_PASSIVE, device_found);
+	if (err && err != -EALREADY) {
+		LOG_ERR("Scanning failed to start (err %d)", err);
+	}
+}
+
+static void connected(struct bt_conn *conn, uint8_t err)
+{
+	struct scanner_node *node = node_by_conn(conn);
+	char addr_str[BT_ADDR_LE_STR_LEN];
+	int64_t t = now_us();
+
+	if (node == NULL) {
+		return;
+	}
+
+	if (node == connecting) {
+		connecting = NULL;
+	}
+
+	if (err) {
+		LOG_ERR("Node %d: connection failed (err 0x%02x)", (int)(node - nodes), err);
+		bt_conn_unref(node->conn);
+		node->conn = NULL;
+		start_scan();
+		return;
+	}
+
+	bt_addr_le_to_str(&node->addr, addr_str, sizeof(addr_str));
+	if (node->disconnected_us >= 0) {
+		LOG_INF("Node %d (%s) reconnected %lld us after the link dropped",
+			(int)(node - nodes), addr_str, t - node->disconnected_us);
+	} else {
+		LOG_INF("Node %d (%s) connected %lld us after its advertisement was seen",
+			(int)(node - nodes), addr_str, t - node->found_us);
+	}
+
+	node->last_result_us = 0;
+	node->discover_params.uuid = &scan_result_uuid.uuid;
+	node->discover_params.func = on_discover;
+	node->discover_params.start_handle = BT_ATT_FIRST_ATTRIBUTE_HANDLE;
+	node->discover_params.end_handle = BT_ATT_LAST_ATTRIBUTE_HANDLE;
+	node->discover_params.type = BT_GATT_DISCOVER_CHARACTERISTIC;
+
+	err = bt_gatt_discover(conn, &node->discover_params);
+	if (err) {
+		LOG_ERR("Node %d: discovery failed (err %d)", (int)(node - nodes), err);
+	}
+
+	// Keep looking for more nodes
+	start_scan();
+}
+
+static void disconnected(struct bt_conn *conn, uint8_t reason)
+{
+	struct scanner_node *node = node_by_conn(conn);
+
+	if (node == NULL) {
+		return;
+	}
+
+	LOG_INF("Node %d disconnected (reason 0x%02x)", (int)(node - nodes), reason);
+	node->disconnected_us = now_us();
+
+	bt_conn_unref(node->conn);
+	node->conn = NULL;
+	start_scan();
+}
+
+BT_CONN_CB_DEFINE(conn_callbacks) = {
+	.connected = connected,
+	.disconnected = disconnected,
+};
+
+int main(void)
+{
+	int err;
+
+	err = bt_enable(NULL);
+	if (err) {
+		LOG_ERR("Bluetooth init failed (err %d)", err);
+		return err;
+	}
+
+	LOG_INF("Collecting from up to %d I2C scanner(s)...", (int)ARRAY_SIZE(nodes));
+	stats_start_us = now_us();
+	k_work_schedule(&stats_work, K_MSEC(CONFIG_CENTRAL_STATS_PERIOD_MS));
+	start_scan();
+	return 0;
+}
@@ -0,0 +1,109 @@
+// Sharing the scanned bus with application drivers
+//
+// Probes are interleaved one at a time with application traffic. Each
+// probe waits until the application has left the bus idle for
+// CONFIG_I2C_SCANNER_SHARE_GAP_US and yields to any application transfer
+// already waiting. Time spent probing is charged to a token bucket that
+// refills at CONFIG_I2C_SCANNER_SHARE_UTIL_PCT of real time, which caps the
+// scanner's share of the bus however long it keeps sweeping.
+//
+// Probe sections nest within one thread, so a multi-transfer sequence that
+// must not be interleaved with application traffic (switch select, probes,
+// deselect) holds the bus once and the probes inside it do not wait again.
+
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+
+#include "bus_share.h"
+
+LOG_MODULE_DECLARE(i2c_scanner, LOG_LEVEL_INF);
+
+// Largest burst of probing the bucket allows, in microseconds
+#define BUDGET_MAX_US \
+	((int64_t)CONFIG_I2C_SCANNER_SHARE_WINDOW_MS * USEC_PER_MSEC * \
+	 CONFIG_I2C_SCANNER_SHARE_UTIL_PCT / 100)
+
+static K_MUTEX_DEFINE(bus_lock);
+static atomic_t app_waiting;
+static int64_t last_app_release;     // ticks
+static int64_t budget_us = BUDGET_MAX_US;
+static int64_t last_refill;          // ticks
+static uint32_t probe_start;         // cycles
+static k_tid_t probe_holder;
+static int probe_depth;
+
+void bus_share_lock(void)
+{
+	atomic_inc(&app_waiting);
+	k_mutex_lock(&bus_lock, K_FOREVER);
+	atomic_dec(&app_waiting);
+}
+
+void bus_share_unlock(void)
+{
+	last_app_release = k_uptime_ticks();
+	k_mutex_unlock(&bus_lock);
+}
+
+static void budget_refill(void)
+{
+	int64_t now = k_uptime_ticks();
+	int64_t elapsed_us = k_ticks_to_us_floor64(now - last_refill);
+
+	last_refill = now;
+	budget_us = MIN(budget_us + elapsed_us * CONFIG_I2C_SCANNER_SHARE_UTIL_PCT / 100,
+			BUDGET_MAX_US);
+}
+
+void bus_share_probe_begin(void)
+{
+	if (probe_holder == k_current_get()) {
+		probe_depth++;
+		return;
+	}
+
+	while (true) {
+		int64_t idle_us;
+		int64_t deficit_us;
+
+		// The bucket is shared by every probing thread and only
+		// touched with the bus held
+		k_mutex_lock(&bus_lock, K_FOREVER);
+
+		budget_refill();
+		if (budget_us <= 0) {
+			deficit_us = -budget_us;
+			k_mutex_unlock(&bus_lock);
+			// Sleep until the bucket holds a probe's worth again
+			k_sleep(K_USEC(deficit_us * 100 / CONFIG_I2C_SCANNER_SHARE_UTIL_PCT + 1));
+			continue;
+		}
+
+		idle_us = k_ticks_to_us_floor64(k_uptime_ticks() - last_app_release);
+		if (atomic_get(&app_waiting) == 0 &&
+		    idle_us >= CONFIG_I2C_SCANNER_SHARE_GAP_US) {
+			break;
+		}
+
+		k_mutex_unlock(&bus_lock);
+		k_sleep(K_USEC(MAX(CONFIG_I2C_SCANNER_SHARE_GAP_US - idle_us, 1)));
+	}
+
+	probe_holder = k_current_get();
+	probe_depth = 1;
+	probe_start = k_cycle_get_32();
+}
+
+void bus_share_probe_end(void)
+{
+	uint32_t cycles;
+
+	if (--probe_depth > 0) {
+		return;
+	}
+
+	cycles = k_cycle_get_32() - probe_start;
+	budget_us -= k_cyc_to_us_ceil32(cycles);
+	probe_holder = NULL;
+	k_mutex_unlock(&bus_lock);
+}
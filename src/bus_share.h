@@ -0,0 +1,35 @@
+// Sharing the scanned bus with application drivers
+
+#ifndef BUS_SHARE_H_
+#define BUS_SHARE_H_
+
+/**
+ * @brief Take the scanned bus for application transfers
+ *
+ * Application code that talks to devices on the scanned bus wraps its
+ * transfers in bus_share_lock()/bus_share_unlock(). A waiting application
+ * always wins over pending probes, so it is delayed by at most the one
+ * probe already on the wire.
+ */
+void bus_share_lock(void);
+
+/**
+ * @brief Release the bus taken with bus_share_lock()
+ */
+void bus_share_unlock(void);
+
+/**
+ * @brief Wait for an idle gap within the utilization budget, then take the bus
+ *
+ * Called by the scanner before each probe, and around any bounded sequence of
+ * scanner transfers that must not be interleaved with application traffic.
+ * Calls nest within one thread: only the outermost one waits and releases.
+ */
+void bus_share_probe_begin(void);
+
+/**
+ * @brief Release the bus after a probe and charge its duration to the budget
+ */
+void bus_share_probe_end(void);
+
+#endif /* BUS_SHARE_H_ */
@@ -0,0 +1,168 @@
+// Streaming of bulk dumps (EEPROM contents, register maps) to the console
+// and to a BLE notification characteristic
+
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+#include <zephyr/sys/byteorder.h>
+#include <string.h>
+
+#if defined(CONFIG_BT)
+#include <zephyr/bluetooth/bluetooth.h>
+#include <zephyr/bluetooth/conn.h>
+#include <zephyr/bluetooth/uuid.h>
+#include <zephyr/bluetooth/gatt.h>
+#endif
+
+#include "dump_stream.h"
+#if defined(CONFIG_I2C_SCANNER_REGDUMP)
+#include "regdump.h"
+#endif
+
+LOG_MODULE_DECLARE(i2c_scanner, LOG_LEVEL_INF);
+
+// Bytes per console line
+#define CONSOLE_LINE_BYTES 16
+
+#if defined(CONFIG_BT)
+#define BT_UUID_I2C_DUMP_SERVICE_VAL \
+	BT_UUID_128_ENCODE(0x12345678, 0x1234, 0x5678, 0x1234, 0x56789abcdef4)
+#define BT_UUID_I2C_DUMP_DATA_VAL \
+	BT_UUID_128_ENCODE(0x12345678, 0x1234, 0x5678, 0x1234, 0x56789abcdef5)
+
+#define BT_UUID_I2C_DUMP_SERVICE BT_UUID_DECLARE_128(BT_UUID_I2C_DUMP_SERVICE_VAL)
+#define BT_UUID_I2C_DUMP_DATA    BT_UUID_DECLARE_128(BT_UUID_I2C_DUMP_DATA_VAL)
+
+// Largest notification payload with the maximum ATT MTU
+#define DUMP_NOTIFY_MAX (BT_L2CAP_RX_MTU - 3)
+
+#if defined(CONFIG_I2C_SCANNER_REGDUMP)
+// GATT write callback: a client requests a register dump
+static ssize_t write_dump_request(struct bt_conn *conn,
+				  const struct bt_gatt_attr *attr,
+				  const void *buf, uint16_t len,
+				  uint16_t offset, uint8_t flags)
+{
+	const struct regdump_request *req = buf;
+	int err;
+
+	if (offset != 0 || len < sizeof(*req)) {
+		return BT_GATT_ERR(BT_ATT_ERR_INVALID_ATTRIBUTE_LEN);
+	}
+
+	// Golden snapshot uploads carry the register values after the request
+	err = regdump_submit(req, (const uint8_t *)buf + sizeof(*req),
+			     len - sizeof(*req));
+	if (err == -EBUSY) {
+		return BT_GATT_ERR(BT_ATT_ERR_PROCEDURE_IN_PROGRESS);
+	} else if (err == -EMSGSIZE) {
+		return BT_GATT_ERR(BT_ATT_ERR_INVALID_ATTRIBUTE_LEN);
+	} else if (err) {
+		return BT_GATT_ERR(BT_ATT_ERR_VALUE_NOT_ALLOWED);
+	}
+
+	return len;
+}
+
+// Register dumps are requested by writing to the dump characteristic
+#define DUMP_DATA_PROPS (BT_GATT_CHRC_NOTIFY | BT_GATT_CHRC_WRITE)
+#define DUMP_DATA_PERM  BT_GATT_PERM_WRITE
+#define DUMP_DATA_WRITE write_dump_request
+#else
+#define DUMP_DATA_PROPS BT_GATT_CHRC_NOTIFY
+#define DUMP_DATA_PERM  BT_GATT_PERM_NONE
+#define DUMP_DATA_WRITE NULL
+#endif /* CONFIG_I2C_SCANNER_REGDUMP */
+
+BT_GATT_SERVICE_DEFINE(i2c_dump_svc,
+	BT_GATT_PRIMARY_SERVICE(BT_UUID_I2C_DUMP_SERVICE),
+	BT_GATT_CHARACTERISTIC(BT_UUID_I2C_DUMP_DATA,
+			       DUMP_DATA_PROPS, DUMP_DATA_PERM,
+			       NULL, DUMP_DATA_WRITE, NULL),
+	BT_GATT_CCC(NULL, BT_GATT_PERM_READ | BT_GATT_PERM_WRITE),
+);
+
+static struct bt_conn *dump_conn;
+
+static void dump_connected(struct bt_conn *conn, uint8_t err)
+{
+	if (!err && dump_conn == NULL) {
+		dump_conn = bt_conn_ref(conn);
+	}
+}
+
+static void dump_disconnected(struct bt_conn *conn, uint8_t reason)
+{
+	if (dump_conn == conn) {
+		bt_conn_unref(dump_conn);
+		dump_conn = NULL;
+	}
+}
+
+BT_CONN_CB_DEFINE(dump_conn_callbacks) = {
+	.connected = dump_connected,
+	.disconnected = dump_disconnected,
+};
+
+void dump_stream_notify(enum dump_type type, uint8_t addr, uint32_t offset,
+			const uint8_t *data, size_t len)
+{
+	const struct bt_gatt_attr *attr = &i2c_dump_svc.attrs[1];
+	uint8_t pdu[DUMP_NOTIFY_MAX];
+	struct dump_chunk_hdr *hdr = (struct dump_chunk_hdr *)pdu;
+	size_t max_data;
+
+	if (dump_conn == NULL ||
+	    !bt_gatt_is_subscribed(dump_conn, attr, BT_GATT_CCC_NOTIFY)) {
+		return;
+	}
+
+	max_data = MIN(bt_gatt_get_mtu(dump_conn) - 3, sizeof(pdu)) - sizeof(*hdr);
+
+	do {
+		size_t n = MIN(len, max_data);
+		int err;
+
+		hdr->type = type;
+		hdr->addr = addr;
+		hdr->offset = sys_cpu_to_le32(offset);
+		memcpy(&pdu[sizeof(*hdr)], data, n);
+
+		err = bt_gatt_notify(dump_conn, attr, pdu, sizeof(*hdr) + n);
+		if (err) {
+			LOG_ERR("BLE dump notify failed (err %d)", err);
+			return;
+		}
+
+		data += n;
+		offset += n;
+		len -= n;
+	} while (len > 0);
+}
+#else
+void dump_stream_notify(enum dump_type type, uint8_t addr, uint32_t offset,
+			const uint8_t *data, size_t len)
+{
+}
+#endif /* CONFIG_BT */
+
+void dump_stream_send(enum dump_type type, uint8_t addr, uint32_t offset,
+		      const uint8_t *data, size_t len)
+{
+	for (size_t i = 0; i < len; i++) {
+		if ((i % CONSOLE_LINE_BYTES) == 0) {
+			printk("%s%02X:%04X:", i ? "\n" : "", addr, (unsigned int)(offset + i));
+		}
+		printk(" %02X", data[i]);
+	}
+	if (len > 0) {
+		printk("\n");
+	}
+
+	dump_stream_notify(type, addr, offset, data, len);
+}
+
+void dump_stream_end(enum dump_type type, uint8_t addr, uint32_t size)
+{
+	LOG_INF("Dump of 0x%02X complete, %u bytes", addr, size);
+	dump_stream_notify(type, addr, size, NULL, 0);
+}
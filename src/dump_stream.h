@@ -0,0 +1,58 @@
+// Streaming of bulk dumps (EEPROM contents, register maps) to the console
+// and to a BLE notification characteristic
+
+#ifndef DUMP_STREAM_H_
+#define DUMP_STREAM_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include <zephyr/toolchain.h>
+
+// Kind of data carried by a dump chunk
+enum dump_type {
+	DUMP_TYPE_EEPROM = 1,
+	DUMP_TYPE_REGMAP_RLE,
+	DUMP_TYPE_REGMAP_DIFF,
+};
+
+// Header preceding the data of every BLE dump notification. A chunk with no
+// data after the header marks the end of a dump, offset then holds the size.
+struct dump_chunk_hdr {
+	uint8_t type;
+	uint8_t addr;
+	uint32_t offset;        // little endian
+} __packed;
+
+/**
+ * @brief Send one chunk of a dump
+ *
+ * The chunk is printed as hex on the console and, when a BLE client is
+ * subscribed, split into notifications as large as the ATT MTU allows.
+ *
+ * @param type Kind of dump
+ * @param addr I2C address of the dumped device
+ * @param offset Offset of the first byte in @p data
+ * @param data Dump data
+ * @param len Number of bytes in @p data
+ */
+void dump_stream_send(enum dump_type type, uint8_t addr, uint32_t offset,
+		      const uint8_t *data, size_t len);
+
+/**
+ * @brief Send one chunk of a dump to BLE subscribers only
+ *
+ * Used for encoded dumps whose console form is printed by the producer.
+ * Arguments are the same as for dump_stream_send().
+ */
+void dump_stream_notify(enum dump_type type, uint8_t addr, uint32_t offset,
+			const uint8_t *data, size_t len);
+
+/**
+ * @brief Mark the end of a dump
+ * @param type Kind of dump
+ * @param addr I2C address of the dumped device
+ * @param size Total number of bytes dumped
+ */
+void dump_stream_end(enum dump_type type, uint8_t addr, uint32_t size);
+
+#endif /* DUMP_STREAM_H_ */
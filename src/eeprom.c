@@ -0,0 +1,319 @@
+// 24Cxx EEPROM discovery, size detection and dumping
+//
+// Detection never writes to the memory array. Only the word address pointer
+// is set, followed by a repeated start read:
+//  - A 1-byte addressed part returns the same data shifted by one byte when
+//    the pointer moves from 0x00 to 0x01.
+//  - Address bits above the array size are ignored, so the first power of
+//    two offset that reads back the data at offset 0 is the array size.
+// Both tests rely on the data at offset 0 being distinctive; near-uniform
+// contents are not trusted, and a wrap only counts when two separate
+// signatures read back at the candidate size.
+// Dumps set the pointer once and then use current address reads, so every
+// further chunk costs only the address byte instead of a full random read.
+// With bus sharing, every read is one bounded chunk taken between application
+// transfers, and dumps use random reads as the application may have moved
+// the pointer in between.
+// Devices declared in devicetree at 0x50-0x57 with a compatible other than
+// "atmel,at24" are left alone: a 16-byte read from register 0 can clear
+// interrupt status or drain a FIFO on such parts. Undeclared devices are
+// still examined, as the whole module is opt-in.
+
+#include <zephyr/kernel.h>
+#include <zephyr/drivers/i2c.h>
+#include <zephyr/logging/log.h>
+#include <string.h>
+
+#include "scanner.h"
+#include "bus_share.h"
+#include "dump_stream.h"
+#include "eeprom.h"
+
+LOG_MODULE_DECLARE(i2c_scanner, LOG_LEVEL_INF);
+
+// Bytes compared when looking for shifted or aliased data
+#define SIG_LEN 16
+
+// Differing adjacent byte pairs required before a signature is trusted
+#define SIG_MIN_EDGES 4
+
+// Smallest and largest 2-byte addressed arrays (24C32 to 24C512)
+#define EEPROM_2BYTE_MIN_SIZE 4096
+#define EEPROM_2BYTE_MAX_SIZE 65536
+
+struct eeprom_info {
+	uint8_t addr_width;     // word address bytes, 0 if unknown
+	uint32_t size;
+};
+
+// Geometry of the EEPROMs at 0x50-0x57, detected and dumped once per
+// appearance on the bus
+static struct eeprom_info eeproms[EEPROM_ADDR_LAST - EEPROM_ADDR_FIRST + 1];
+static uint8_t known_mask;
+
+#define I2C_SCAN_NODE DT_CHOSEN(i2c_scanner_bus)
+
+#define NON_EEPROM_DECL(node)							\
+	COND_CODE_1(DT_NODE_HAS_COMPAT(node, atmel_at24), (),			\
+	(COND_CODE_1(DT_NODE_HAS_PROP(node, reg), (DT_REG_ADDR(node),), ())))
+
+// Addresses of devicetree children of the scanned bus that are not EEPROMs
+static const uint8_t declared_non_eeproms[] = {
+	DT_FOREACH_CHILD_STATUS_OKAY(I2C_SCAN_NODE, NON_EEPROM_DECL)
+};
+
+/**
+ * @brief Check whether an address is declared in devicetree as another part
+ */
+static bool is_declared_non_eeprom(uint8_t addr)
+{
+	for (size_t i = 0; i < ARRAY_SIZE(declared_non_eeproms); i++) {
+		if (declared_non_eeproms[i] == addr) {
+			return true;
+		}
+	}
+	return false;
+}
+
+/**
+ * @brief Random read from an EEPROM
+ * @param addr I2C address
+ * @param width Word address width in bytes (1 or 2)
+ * @param offset Word address to start reading from
+ * @param buf Receives the data
+ * @param len Number of bytes to read
+ * @return 0 on success, negative error code otherwise
+ */
+static int eeprom_read_at(uint8_t addr, uint8_t width, uint32_t offset,
+			  uint8_t *buf, size_t len)
+{
+	uint8_t wbuf[2] = { offset >> 8, offset & 0xFF };
+	int ret;
+
+	if (IS_ENABLED(CONFIG_I2C_SCANNER_SHARE)) {
+		bus_share_probe_begin();
+	}
+
+	if (width == 1) {
+		ret = i2c_write_read(i2c_dev, addr, &wbuf[1], 1, buf, len);
+	} else {
+		ret = i2c_write_read(i2c_dev, addr, wbuf, 2, buf, len);
+	}
+
+	if (IS_ENABLED(CONFIG_I2C_SCANNER_SHARE)) {
+		bus_share_probe_end();
+	}
+
+	return ret;
+}
+
+static bool is_distinctive(const uint8_t *buf, size_t len)
+{
+	int edges = 0;
+
+	for (size_t i = 1; i < len; i++) {
+		if (buf[i] != buf[i - 1]) {
+			edges++;
+		}
+	}
+	return edges >= SIG_MIN_EDGES;
+}
+
+/**
+ * @brief Check whether the array wraps around at @p size
+ *
+ * The signatures from offset 0 and offset SIG_LEN must both read back at
+ * @p size, so a repeat of the first signature elsewhere in the array is not
+ * mistaken for the address wrapping.
+ *
+ * @return 1 if the array wraps, 0 if not, negative error code otherwise
+ */
+static int eeprom_wraps_at(uint8_t addr, uint8_t width, uint32_t size,
+			   const uint8_t sig[2][SIG_LEN])
+{
+	uint8_t buf[SIG_LEN];
+	int ret;
+
+	for (int i = 0; i < 2; i++) {
+		ret = eeprom_read_at(addr, width, size + i * SIG_LEN, buf, sizeof(buf));
+		if (ret < 0) {
+			return ret;
+		}
+		if (memcmp(sig[i], buf, sizeof(buf)) != 0) {
+			return 0;
+		}
+	}
+
+	return 1;
+}
+
+/**
+ * @brief Infer the word address width and array size of an EEPROM
+ *
+ * Blank or near-uniform contents make both tests inconclusive; such parts
+ * are reported with an unknown width and are not dumped.
+ *
+ * @param addr I2C address
+ * @param info Filled in with the detected geometry
+ * @return 0 on success, negative error code otherwise
+ */
+static int eeprom_detect(uint8_t addr, struct eeprom_info *info)
+{
+	uint8_t sig[2][SIG_LEN];
+	uint8_t buf[SIG_LEN];
+	int ret;
+
+	info->addr_width = 0;
+	info->size = 0;
+
+	ret = eeprom_read_at(addr, 1, 0x00, sig[0], sizeof(sig[0]));
+	if (ret < 0) {
+		return ret;
+	}
+
+	if (!is_distinctive(sig[0], sizeof(sig[0]))) {
+		return 0;
+	}
+
+	ret = eeprom_read_at(addr, 1, 0x01, buf, sizeof(buf));
+	if (ret < 0) {
+		return ret;
+	}
+
+	if (memcmp(&sig[0][1], buf, sizeof(sig[0]) - 1) == 0) {
+		// 24C01 wraps at 128 bytes, 24C02 and the upper blocks of
+		// 24C04/08/16 parts hold 256 bytes per address
+		info->addr_width = 1;
+		ret = eeprom_read_at(addr, 1, SIG_LEN, sig[1], sizeof(sig[1]));
+		if (ret < 0) {
+			return ret;
+		}
+		ret = eeprom_wraps_at(addr, 1, 0x80, sig);
+		if (ret < 0) {
+			return ret;
+		}
+		info->size = ret ? 128 : 256;
+		return 0;
+	}
+
+	// Not 1-byte addressed: now a 2-byte pointer write is safe
+	for (int i = 0; i < 2; i++) {
+		ret = eeprom_read_at(addr, 2, i * SIG_LEN, sig[i], sizeof(sig[i]));
+		if (ret < 0) {
+			return ret;
+		}
+	}
+
+	if (!is_distinctive(sig[0], sizeof(sig[0]))) {
+		return 0;
+	}
+
+	info->addr_width = 2;
+	info->size = EEPROM_2BYTE_MAX_SIZE;
+	for (uint32_t size = EEPROM_2BYTE_MIN_SIZE; size < EEPROM_2BYTE_MAX_SIZE;
+	     size *= 2) {
+		ret = eeprom_wraps_at(addr, 2, size, sig);
+		if (ret < 0) {
+			return ret;
+		}
+		if (ret) {
+			info->size = size;
+			break;
+		}
+	}
+
+	return 0;
+}
+
+/**
+ * @brief Stream the whole array using maximal sequential reads
+ * @param addr I2C address
+ * @param info Geometry from eeprom_detect()
+ * @return 0 on success, negative error code otherwise
+ */
+static int eeprom_dump(uint8_t addr, const struct eeprom_info *info)
+{
+	static uint8_t chunk[CONFIG_I2C_SCANNER_EEPROM_CHUNK];
+	int64_t start_ms = k_uptime_get();
+	uint32_t offset = 0;
+	int ret;
+
+	while (offset < info->size) {
+		size_t len = MIN(sizeof(chunk), info->size - offset);
+
+		// The word address pointer only needs setting once, the
+		// internal counter continues from where the last chunk ended
+		if (offset == 0 || IS_ENABLED(CONFIG_I2C_SCANNER_SHARE)) {
+			ret = eeprom_read_at(addr, info->addr_width, offset, chunk, len);
+		} else {
+			ret = i2c_read(i2c_dev, chunk, len, addr);
+		}
+		if (ret < 0) {
+			LOG_ERR("EEPROM 0x%02X read at 0x%04X failed: %d",
+				addr, (unsigned int)offset, ret);
+			return ret;
+		}
+
+		dump_stream_send(DUMP_TYPE_EEPROM, addr, offset, chunk, len);
+		offset += len;
+	}
+
+	dump_stream_end(DUMP_TYPE_EEPROM, addr, info->size);
+	LOG_INF("EEPROM 0x%02X dumped in %u ms", addr,
+		(uint32_t)(k_uptime_get() - start_ms));
+	return 0;
+}
+
+int eeprom_discover(const uint8_t state[I2C_NUM_ADDRS])
+{
+	int count = 0;
+	int block = 0;
+
+	for (uint8_t addr = EEPROM_ADDR_FIRST; addr <= EEPROM_ADDR_LAST; addr++) {
+		uint8_t idx = addr - EEPROM_ADDR_FIRST;
+		struct eeprom_info *info = &eeproms[idx];
+		bool is_new = false;
+
+		if (state[addr] != PROBE_PRESENT || is_declared_non_eeprom(addr)) {
+			known_mask &= ~BIT(idx);
+			block = 0;
+			continue;
+		}
+
+		if (!(known_mask & BIT(idx))) {
+			if (eeprom_detect(addr, info) < 0) {
+				block = 0;
+				continue;
+			}
+			known_mask |= BIT(idx);
+			is_new = true;
+
+			if (info->addr_width == 0) {
+				LOG_INF("EEPROM 0x%02X: blank or unknown geometry", addr);
+			} else {
+				LOG_INF("EEPROM 0x%02X: %u bytes, %d-byte addressing",
+					addr, info->size, info->addr_width);
+			}
+		}
+		count++;
+
+		// 24C04/08/16 parts answer on 2, 4 or 8 consecutive addresses
+		// with 256 bytes each
+		if (info->addr_width == 1 && info->size == 256) {
+			block++;
+			if (is_new && block > 1) {
+				LOG_INF("EEPROM block 0x%02X-0x%02X: %d bytes",
+					addr - block + 1, addr, block * 256);
+			}
+		} else {
+			block = 0;
+		}
+
+		if (IS_ENABLED(CONFIG_I2C_SCANNER_EEPROM_DUMP) && is_new &&
+		    info->addr_width != 0) {
+			eeprom_dump(addr, info);
+		}
+	}
+
+	return count;
+}
@@ -0,0 +1,27 @@
+// 24Cxx EEPROM discovery, size detection and dumping
+
+#ifndef EEPROM_H_
+#define EEPROM_H_
+
+#include <stdint.h>
+
+#include "scanner.h"
+
+// Addresses used by 24Cxx EEPROMs (board IDs, SPD)
+#define EEPROM_ADDR_FIRST 0x50
+#define EEPROM_ADDR_LAST  0x57
+
+/**
+ * @brief Detect EEPROMs at 0x50-0x57 and dump newly found ones
+ *
+ * Word address width and array size are inferred without writing to the
+ * array. With CONFIG_I2C_SCANNER_EEPROM_DUMP each EEPROM is streamed once
+ * after it appears on the bus. Addresses declared in devicetree with a
+ * compatible other than "atmel,at24" are skipped.
+ *
+ * @param state Per-address probe state of the completed sweep
+ * @return Number of EEPROMs present
+ */
+int eeprom_discover(const uint8_t state[I2C_NUM_ADDRS]);
+
+#endif /* EEPROM_H_ */
@@ -0,0 +1,158 @@
+// MAX30101 FIFO streaming rate measurement
+//
+// Configures the first "maxim,max30101" node for heart rate mode at a fixed
+// sample rate and drains its FIFO periodically from the system work queue,
+// the way a sensor driver would: the write, overflow and read pointers are
+// fetched in one burst, then all unread samples in a second one. The whole
+// drain holds the scanned bus through bus_share, so a scanner probe of the
+// sensor's address cannot land between the FIFO_DATA read and the pointer
+// reset that follows it and consume a sample byte. Once per
+// report period the number of samples and bytes read is logged as a rate,
+// together with any overflows. On native_sim the samples are produced by
+// the emulator in simulated time, so the rate checks both the emulated FIFO
+// and the modelled bus time.
+
+#include <zephyr/kernel.h>
+#include <zephyr/drivers/i2c.h>
+#include <zephyr/logging/log.h>
+
+#include "fifo_rate.h"
+#include "bus_share.h"
+
+LOG_MODULE_DECLARE(i2c_scanner, LOG_LEVEL_INF);
+
+#define MAX30101_NODE DT_COMPAT_GET_ANY_STATUS_OKAY(maxim_max30101)
+
+#define REG_FIFO_WR         0x04
+#define REG_FIFO_DATA       0x07
+#define REG_FIFO_CFG        0x08
+#define REG_MODE_CFG        0x09
+#define REG_SPO2_CFG        0x0A
+
+#define FIFO_CFG_ROLLOVER   BIT(4)
+#define MODE_CFG_RESET      BIT(6)
+#define MODE_HEART_RATE     0x02
+
+#define FIFO_DEPTH          32
+#define SAMPLE_BYTES        3       // one channel in heart rate mode
+
+// 400 samples per second (SR = 3), no averaging
+#define SAMPLE_RATE         400
+#define SPO2_CFG_SR_400     (3 << 2)
+
+// Drain often enough that the FIFO never fills between two polls
+#define POLL_MS             20
+#define REPORT_MS           1000
+
+BUILD_ASSERT(POLL_MS * SAMPLE_RATE / MSEC_PER_SEC < FIFO_DEPTH,
+	     "FIFO would overflow between polls");
+
+static const struct i2c_dt_spec sensor = I2C_DT_SPEC_GET(MAX30101_NODE);
+
+static uint8_t samples[FIFO_DEPTH * SAMPLE_BYTES];
+static uint32_t samples_read;
+static uint8_t overflows;      // highest overflow counter seen in the window
+static int64_t window_start;
+
+static void fifo_rate_work_handler(struct k_work *work);
+static K_WORK_DELAYABLE_DEFINE(fifo_rate_work, fifo_rate_work_handler);
+
+/**
+ * @brief Read all unread samples from the FIFO, with the bus held
+ * @return Number of samples read, or negative error code
+ */
+static int fifo_drain(void)
+{
+	uint8_t reg = REG_FIFO_WR;
+	uint8_t ptrs[3];        // FIFO_WR, OVF_COUNTER, FIFO_RD
+	int count;
+	int ret;
+
+	ret = i2c_write_read_dt(&sensor, &reg, 1, ptrs, sizeof(ptrs));
+	if (ret < 0) {
+		return ret;
+	}
+
+	// Equal pointers also mean a full FIFO, which the overflow counter
+	// tells apart from an empty one
+	count = (ptrs[0] - ptrs[2]) & (FIFO_DEPTH - 1);
+	if (count == 0 && ptrs[1] != 0) {
+		count = FIFO_DEPTH;
+	}
+	overflows = MAX(overflows, ptrs[1]);
+	if (count == 0) {
+		return 0;
+	}
+
+	reg = REG_FIFO_DATA;
+	ret = i2c_write_read_dt(&sensor, &reg, 1, samples, count * SAMPLE_BYTES);
+	if (ret < 0) {
+		return ret;
+	}
+
+	// Leave the register pointer off FIFO_DATA before the bus is
+	// released, a probe of the address would otherwise consume a sample
+	// byte
+	reg = REG_FIFO_WR;
+	i2c_write_dt(&sensor, &reg, 1);
+
+	return count;
+}
+
+static void fifo_rate_work_handler(struct k_work *work)
+{
+	int64_t elapsed_ms;
+	int ret;
+
+	bus_share_lock();
+	ret = fifo_drain();
+	bus_share_unlock();
+	if (ret < 0) {
+		LOG_ERR("FIFO read from 0x%02X failed: %d", sensor.addr, ret);
+	} else {
+		samples_read += ret;
+	}
+
+	elapsed_ms = k_uptime_get() - window_start;
+	if (elapsed_ms >= REPORT_MS) {
+		uint32_t rate = samples_read * MSEC_PER_SEC / elapsed_ms;
+
+		LOG_INF("FIFO rate: %u samples/s, %u bytes/s, %u overflow(s)", rate,
+			rate * SAMPLE_BYTES, overflows);
+		samples_read = 0;
+		overflows = 0;
+		window_start += elapsed_ms;
+	}
+
+	k_work_schedule(&fifo_rate_work, K_MSEC(POLL_MS));
+}
+
+int fifo_rate_init(void)
+{
+	const uint8_t config[][2] = {
+		{ REG_MODE_CFG, MODE_CFG_RESET },
+		{ REG_FIFO_CFG, FIFO_CFG_ROLLOVER },
+		{ REG_SPO2_CFG, SPO2_CFG_SR_400 },
+		{ REG_MODE_CFG, MODE_HEART_RATE },
+	};
+	int ret;
+
+	if (!i2c_is_ready_dt(&sensor)) {
+		LOG_ERR("MAX30101 bus not ready!");
+		return -ENODEV;
+	}
+
+	for (size_t i = 0; i < ARRAY_SIZE(config); i++) {
+		ret = i2c_write_dt(&sensor, config[i], sizeof(config[i]));
+		if (ret < 0) {
+			LOG_ERR("MAX30101 configuration failed: %d", ret);
+			return ret;
+		}
+	}
+
+	LOG_INF("Measuring the FIFO rate of 0x%02X at %d samples/s", sensor.addr,
+		SAMPLE_RATE);
+	window_start = k_uptime_get();
+	k_work_schedule(&fifo_rate_work, K_MSEC(POLL_MS));
+	return 0;
+}
@@ -0,0 +1,16 @@
+// MAX30101 FIFO streaming rate measurement
+
+#ifndef FIFO_RATE_H_
+#define FIFO_RATE_H_
+
+/**
+ * @brief Configure the MAX30101 and start draining its FIFO periodically
+ *
+ * The achieved sample rate is logged as "FIFO rate: <n> samples/s" once per
+ * second.
+ *
+ * @return 0 on success, negative error code otherwise
+ */
+int fifo_rate_init(void);
+
+#endif /* FIFO_RATE_H_ */
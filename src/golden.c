@@ -0,0 +1,155 @@
+// Golden register snapshots and on-device comparison
+//
+// Snapshots are kept in the settings subsystem under the chip fingerprint,
+// so a known-good board can store them and a board under test is compared
+// locally, streaming only the registers that differ.
+
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+#include <zephyr/settings/settings.h>
+#include <zephyr/sys/byteorder.h>
+#include <stdio.h>
+
+#include "dump_stream.h"
+#include "golden.h"
+
+LOG_MODULE_DECLARE(i2c_scanner, LOG_LEVEL_INF);
+
+#define GOLDEN_KEY_FMT "i2cscan/golden/%08x"
+#define GOLDEN_KEY_LEN sizeof("i2cscan/golden/01234567")
+
+// Mismatches collected before a BLE notification is sent
+#define MISMATCH_BATCH 16
+
+static uint8_t golden[CONFIG_I2C_SCANNER_REGDUMP_MAX];
+static bool settings_ready;
+
+struct golden_load_ctx {
+	size_t len;
+	int err;
+};
+
+static int golden_settings_init(void)
+{
+	int err;
+
+	if (settings_ready) {
+		return 0;
+	}
+
+	err = settings_subsys_init();
+	if (err) {
+		LOG_ERR("Settings init failed (err %d)", err);
+		return err;
+	}
+
+	settings_ready = true;
+	return 0;
+}
+
+static int golden_load_cb(const char *key, size_t len, settings_read_cb read_cb,
+			  void *cb_arg, void *param)
+{
+	struct golden_load_ctx *ctx = param;
+	ssize_t ret;
+
+	if (len > sizeof(golden)) {
+		ctx->err = -ENOMEM;
+		return 0;
+	}
+
+	ret = read_cb(cb_arg, golden, len);
+	if (ret < 0) {
+		ctx->err = ret;
+		return 0;
+	}
+
+	ctx->len = ret;
+	ctx->err = 0;
+	return 0;
+}
+
+int golden_save(uint32_t fingerprint, const uint8_t *regs, size_t count)
+{
+	char key[GOLDEN_KEY_LEN];
+	int err;
+
+	err = golden_settings_init();
+	if (err) {
+		return err;
+	}
+
+	snprintf(key, sizeof(key), GOLDEN_KEY_FMT, fingerprint);
+	err = settings_save_one(key, regs, count);
+	if (err) {
+		LOG_ERR("Saving golden snapshot %08x failed (err %d)", fingerprint, err);
+		return err;
+	}
+
+	LOG_INF("Golden snapshot %08x saved, %u registers", fingerprint,
+		(unsigned int)count);
+	return 0;
+}
+
+int golden_compare(uint32_t fingerprint, uint8_t addr, uint16_t start,
+		   const uint8_t *regs, size_t count)
+{
+	struct golden_load_ctx ctx = { .err = -ENOENT };
+	struct golden_mismatch batch[MISMATCH_BATCH];
+	char key[GOLDEN_KEY_LEN];
+	int mismatches = 0;
+	int batched = 0;
+	int err;
+
+	err = golden_settings_init();
+	if (err) {
+		return err;
+	}
+
+	snprintf(key, sizeof(key), GOLDEN_KEY_FMT, fingerprint);
+	err = settings_load_subtree_direct(key, golden_load_cb, &ctx);
+	if (err) {
+		return err;
+	}
+	if (ctx.err) {
+		if (ctx.err == -ENOENT) {
+			LOG_WRN("No golden snapshot %08x for 0x%02X", fingerprint, addr);
+		}
+		return ctx.err;
+	}
+	if (ctx.len != count) {
+		LOG_ERR("Golden snapshot %08x holds %u registers, expected %u",
+			fingerprint, (unsigned int)ctx.len, (unsigned int)count);
+		return -EINVAL;
+	}
+
+	for (size_t i = 0; i < count; i++) {
+		if (regs[i] == golden[i]) {
+			continue;
+		}
+
+		LOG_WRN("0x%02X reg 0x%04X: 0x%02X, golden 0x%02X", addr,
+			(unsigned int)(start + i), regs[i], golden[i]);
+
+		batch[batched].reg = sys_cpu_to_le16(start + i);
+		batch[batched].actual = regs[i];
+		batch[batched].golden = golden[i];
+		if (++batched == MISMATCH_BATCH) {
+			dump_stream_notify(DUMP_TYPE_REGMAP_DIFF, addr,
+					   mismatches + 1 - batched, (uint8_t *)batch,
+					   sizeof(batch));
+			batched = 0;
+		}
+		mismatches++;
+	}
+
+	if (batched > 0) {
+		dump_stream_notify(DUMP_TYPE_REGMAP_DIFF, addr, mismatches - batched,
+				   (uint8_t *)batch, batched * sizeof(batch[0]));
+	}
+	dump_stream_end(DUMP_TYPE_REGMAP_DIFF, addr, mismatches);
+
+	LOG_INF("0x%02X vs golden %08x: %d of %u registers differ", addr,
+		fingerprint, mismatches, (unsigned int)count);
+	return mismatches;
+}
@@ -0,0 +1,43 @@
+// Golden register snapshots and on-device comparison
+
+#ifndef GOLDEN_H_
+#define GOLDEN_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include <zephyr/toolchain.h>
+
+// One mismatching register, as streamed in a DUMP_TYPE_REGMAP_DIFF dump
+struct golden_mismatch {
+	uint16_t reg;           // little endian
+	uint8_t actual;
+	uint8_t golden;
+} __packed;
+
+/**
+ * @brief Store a register map as the golden snapshot of a chip
+ * @param fingerprint Chip fingerprint
+ * @param regs Register values
+ * @param count Number of registers
+ * @return 0 on success, negative error code otherwise
+ */
+int golden_save(uint32_t fingerprint, const uint8_t *regs, size_t count);
+
+/**
+ * @brief Compare a register map with the golden snapshot of a chip
+ *
+ * Only mismatching registers are reported, on the console and as a
+ * DUMP_TYPE_REGMAP_DIFF dump.
+ *
+ * @param fingerprint Chip fingerprint
+ * @param addr I2C address of the chip
+ * @param start First register of @p regs
+ * @param regs Register values
+ * @param count Number of registers
+ * @return Number of mismatching registers, -ENOENT if no snapshot is stored,
+ *         other negative error code on failure
+ */
+int golden_compare(uint32_t fingerprint, uint8_t addr, uint16_t start,
+		   const uint8_t *regs, size_t count);
+
+#endif /* GOLDEN_H_ */
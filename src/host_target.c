@@ -0,0 +1,187 @@
+// Scan results for a host MCU over an I2C target interface
+//
+// The scanner registers as a target on a second controller and serves a
+// small register map with the latest results. The host fetches the whole
+// inventory in one burst read whenever it likes; no traffic reaches the
+// scanned bus on its behalf. Target callbacks run in interrupt context, so
+// each host read works on a copy of the map taken when the read starts.
+//
+// When an i2c-scanner,target-host controller is given (native_sim), the map
+// is read back through it after every publish, the way a host would.
+
+#include <zephyr/kernel.h>
+#include <zephyr/drivers/i2c.h>
+#include <zephyr/logging/log.h>
+#include <zephyr/sys/byteorder.h>
+#include <zephyr/spinlock.h>
+#include <string.h>
+
+#include "presence_stats.h"
+#include "host_target.h"
+
+LOG_MODULE_DECLARE(i2c_scanner, LOG_LEVEL_INF);
+
+BUILD_ASSERT(DT_HAS_CHOSEN(i2c_scanner_target_bus),
+	     "CONFIG_I2C_SCANNER_TARGET needs an i2c-scanner,target-bus chosen node");
+
+static const struct device *target_dev = DEVICE_DT_GET(DT_CHOSEN(i2c_scanner_target_bus));
+
+#if defined(CONFIG_I2C_SCANNER_TARGET_READBACK)
+static const struct device *host_dev = DEVICE_DT_GET(DT_CHOSEN(i2c_scanner_target_host));
+#endif
+
+static struct host_target_regs regs = {
+	.magic = HOST_TARGET_MAGIC,
+	.version = HOST_TARGET_VERSION,
+};
+static struct k_spinlock regs_lock;
+
+// State of the host transaction, only touched by the target callbacks
+static struct host_target_regs snapshot;
+static uint8_t reg_ptr;
+static bool ptr_pending;
+
+static uint8_t next_byte(void)
+{
+	const uint8_t *map = (const uint8_t *)&snapshot;
+
+	// Reads beyond the map return 0xFF like an unconnected bus
+	if (reg_ptr >= sizeof(snapshot)) {
+		return 0xFF;
+	}
+	return map[reg_ptr++];
+}
+
+static int target_write_requested(struct i2c_target_config *config)
+{
+	ptr_pending = true;
+	return 0;
+}
+
+static int target_write_received(struct i2c_target_config *config, uint8_t val)
+{
+	// The first byte sets the register pointer, the map is read-only
+	if (!ptr_pending) {
+		return -EIO;
+	}
+
+	reg_ptr = val;
+	ptr_pending = false;
+	return 0;
+}
+
+static int target_read_requested(struct i2c_target_config *config, uint8_t *val)
+{
+	K_SPINLOCK(&regs_lock) {
+		snapshot = regs;
+	}
+
+	*val = next_byte();
+	return 0;
+}
+
+static int target_read_processed(struct i2c_target_config *config, uint8_t *val)
+{
+	*val = next_byte();
+	return 0;
+}
+
+static int target_stop(struct i2c_target_config *config)
+{
+	ptr_pending = false;
+	return 0;
+}
+
+static const struct i2c_target_callbacks target_callbacks = {
+	.write_requested = target_write_requested,
+	.write_received = target_write_received,
+	.read_requested = target_read_requested,
+	.read_processed = target_read_processed,
+	.stop = target_stop,
+};
+
+static struct i2c_target_config target_config = {
+	.address = CONFIG_I2C_SCANNER_TARGET_ADDR,
+	.callbacks = &target_callbacks,
+};
+
+int host_target_init(void)
+{
+	int ret;
+
+	if (!device_is_ready(target_dev)) {
+		LOG_ERR("I2C target device %s not ready!", target_dev->name);
+		return -ENODEV;
+	}
+
+	ret = i2c_target_register(target_dev, &target_config);
+	if (ret < 0) {
+		LOG_ERR("I2C target registration failed: %d", ret);
+		return ret;
+	}
+
+	LOG_INF("Scan results served at 0x%02X on %s", target_config.address,
+		target_dev->name);
+	return 0;
+}
+
+#if defined(CONFIG_I2C_SCANNER_TARGET_READBACK)
+/**
+ * @brief Read the whole register map back as the host would and check it
+ * @param seq Sequence number expected in the map
+ */
+static void host_readback(uint8_t seq)
+{
+	struct host_target_regs rb;
+	uint8_t reg = 0;
+	int ret;
+
+	ret = i2c_write_read(host_dev, target_config.address, &reg, 1, &rb, sizeof(rb));
+	if (ret < 0) {
+		LOG_ERR("Host readback failed: %d", ret);
+		return;
+	}
+
+	if (rb.magic != HOST_TARGET_MAGIC || rb.seq != seq) {
+		LOG_ERR("Host readback mismatch: magic 0x%02X seq %u, expected seq %u",
+			rb.magic, rb.seq, seq);
+		return;
+	}
+
+	LOG_INF("Host readback: seq %u, %u device(s), %u stats entries, %u scans",
+		rb.seq, rb.device_count, rb.stats_count, sys_le32_to_cpu(rb.scans));
+}
+#endif /* CONFIG_I2C_SCANNER_TARGET_READBACK */
+
+void host_target_publish(const uint32_t present[I2C_NUM_ADDRS / 32], int device_count,
+			 uint8_t flags, int declared_missing, uint32_t sweep_ms)
+{
+	struct presence_report stats[HOST_TARGET_STATS_MAX] = { 0 };
+	int stats_count = 0;
+	uint8_t seq = 0;
+
+	if (IS_ENABLED(CONFIG_I2C_SCANNER_STATS)) {
+		stats_count = presence_stats_get(stats, ARRAY_SIZE(stats));
+	}
+
+	K_SPINLOCK(&regs_lock) {
+		regs.seq++;
+		regs.device_count = MIN(device_count, UINT8_MAX);
+		regs.flags = flags;
+		regs.declared_missing = MIN(declared_missing, UINT8_MAX);
+		regs.sweep_ms = sys_cpu_to_le16(MIN(sweep_ms, UINT16_MAX));
+		regs.scans = sys_cpu_to_le32(sys_le32_to_cpu(regs.scans) + 1);
+		for (int i = 0; i < ARRAY_SIZE(regs.present); i++) {
+			regs.present[i] = sys_cpu_to_le32(present[i]);
+		}
+		regs.stats_count = stats_count;
+		memcpy(regs.stats, stats, sizeof(regs.stats));
+		seq = regs.seq;
+	}
+
+#if defined(CONFIG_I2C_SCANNER_TARGET_READBACK)
+	host_readback(seq);
+#else
+	ARG_UNUSED(seq);
+#endif
+}
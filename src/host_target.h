@@ -0,0 +1,63 @@
+// Scan results for a host MCU over an I2C target interface
+
+#ifndef HOST_TARGET_H_
+#define HOST_TARGET_H_
+
+#include <stdint.h>
+#include <zephyr/toolchain.h>
+
+#include "scanner.h"
+#include "presence_stats.h"
+
+// Value of the first register, lets the host check it talks to the scanner
+#define HOST_TARGET_MAGIC   0x5C
+#define HOST_TARGET_VERSION 2
+
+// Presence statistics entries carried in the register map
+#define HOST_TARGET_STATS_MAX 8
+
+// Register map seen by the host. Registers auto-increment on reads, so the
+// whole map is fetched by writing the register pointer (0x00) and reading
+// sizeof(struct host_target_regs) bytes. Multi-byte values are little endian.
+struct host_target_regs {
+	uint8_t magic;              // 0x00
+	uint8_t version;            // 0x01
+	uint8_t seq;                // 0x02 incremented per published scan
+	uint8_t device_count;       // 0x03 devices on the root bus, 7-bit
+	uint8_t flags;              // 0x04 scan result flags
+	uint8_t declared_missing;   // 0x05 declared devices not responding
+	uint16_t sweep_ms;          // 0x06 duration of the last sweep
+	uint32_t scans;             // 0x08 scans since boot
+	uint32_t present[I2C_NUM_ADDRS / 32];   // 0x0C bit n set if address n answered
+	uint8_t stats_count;        // 0x1C valid entries in stats[]
+	// 0x1D presence statistics of the first tracked addresses, all zero
+	// without CONFIG_I2C_SCANNER_STATS
+	struct presence_report stats[HOST_TARGET_STATS_MAX];
+} __packed;
+
+BUILD_ASSERT(sizeof(struct host_target_regs) <= UINT8_MAX,
+	     "Register map must fit the 8-bit register pointer");
+
+/**
+ * @brief Register as an I2C target on the "i2c-scanner,target-bus" controller
+ * @return 0 on success, negative error code otherwise
+ */
+int host_target_init(void);
+
+/**
+ * @brief Publish the results of a scan to the host
+ *
+ * The register map is replaced atomically; a host read in progress keeps
+ * returning the snapshot taken when it started. The presence statistics are
+ * taken from the statistics module at the time of the call.
+ *
+ * @param present Address bitmap of the scan
+ * @param device_count Number of devices found
+ * @param flags Scan result flags
+ * @param declared_missing Number of declared devices not responding
+ * @param sweep_ms Sweep duration in milliseconds
+ */
+void host_target_publish(const uint32_t present[I2C_NUM_ADDRS / 32], int device_count,
+			 uint8_t flags, int declared_missing, uint32_t sweep_ms);
+
+#endif /* HOST_TARGET_H_ */
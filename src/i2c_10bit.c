@@ -0,0 +1,156 @@
+// 10-bit I2C address sweep
+//
+// 10-bit addresses are sent as a 11110xx prefix byte followed by the low
+// address byte, so these devices never show up in the 7-bit sweep. The
+// sweep first tries a zero-length write, which costs only the address phase,
+// and falls back to a one byte read on controllers that reject empty
+// messages.
+
+#include <zephyr/kernel.h>
+#include <zephyr/drivers/i2c.h>
+#include <zephyr/logging/log.h>
+
+#include "scanner.h"
+#include "i2c_10bit.h"
+#include "bus_share.h"
+#include "scan_progress.h"
+
+LOG_MODULE_DECLARE(i2c_scanner, LOG_LEVEL_INF);
+
+// Number of addresses between progress messages
+#define PROGRESS_STEP 256
+
+// Probe method selected at the start of each sweep
+static bool use_empty_write;
+
+/**
+ * @brief Test if a device exists at the given 10-bit address
+ * @param addr 10-bit I2C address to test
+ * @return 0 if device found, negative error code otherwise
+ */
+static int test_i2c_address_10bit(uint16_t addr)
+{
+	uint8_t dummy_data;
+	struct i2c_msg msg = {
+		.buf = &dummy_data,
+		.len = 1,
+		.flags = I2C_MSG_READ | I2C_MSG_STOP | I2C_MSG_ADDR_10_BITS,
+	};
+	int ret;
+
+	if (use_empty_write) {
+		msg.buf = NULL;
+		msg.len = 0;
+		msg.flags = I2C_MSG_WRITE | I2C_MSG_STOP | I2C_MSG_ADDR_10_BITS;
+	}
+
+	if (IS_ENABLED(CONFIG_I2C_SCANNER_SHARE)) {
+		bus_share_probe_begin();
+	}
+
+	ret = i2c_transfer(i2c_dev, &msg, 1, addr);
+
+	if (IS_ENABLED(CONFIG_I2C_SCANNER_SHARE)) {
+		bus_share_probe_end();
+	}
+
+	return ret;
+}
+
+/**
+ * @brief Pick the cheapest probe the controller accepts
+ *
+ * The capability probe addresses 0x000. A controller without 10-bit support
+ * normally rejects the message with -EINVAL or -ENOTSUP, but some simply
+ * fail it like a NACK, which an empty address 0x000 also produces.
+ *
+ * @return 0 if 10-bit probing works, -EIO if the probe was NACKed so support
+ *         is unknown, -ENOTSUP otherwise
+ */
+static int select_probe_method(void)
+{
+	int ret;
+
+	use_empty_write = true;
+	ret = test_i2c_address_10bit(0);
+	if (ret != -EINVAL && ret != -ENOTSUP) {
+		return (ret == 0) ? 0 : -EIO;
+	}
+
+	use_empty_write = false;
+	ret = test_i2c_address_10bit(0);
+	if (ret != -EINVAL && ret != -ENOTSUP) {
+		return (ret == 0) ? 0 : -EIO;
+	}
+
+	return -ENOTSUP;
+}
+
+int scan_i2c_bus_10bit(uint16_t *found, int max_found)
+{
+	int devices_found = 0;
+	int row_start = -1;
+	int method = select_probe_method();
+
+	if (method == -ENOTSUP) {
+		LOG_WRN("10-bit addressing not supported by %s", i2c_dev->name);
+		return -ENOTSUP;
+	}
+	if (method == -EIO) {
+		LOG_WRN("10-bit capability probe NACKed on %s, support unknown",
+			i2c_dev->name);
+	}
+
+	LOG_INF("Scanning 10-bit addresses (%s probe)...",
+		use_empty_write ? "empty write" : "1-byte read");
+
+	for (uint16_t addr = 0; addr < I2C_NUM_ADDRS_10BIT; addr++) {
+		if (addr > 0 && (addr % PROGRESS_STEP) == 0) {
+			LOG_INF("10-bit sweep: %d/%d, %d found", addr,
+				I2C_NUM_ADDRS_10BIT, devices_found);
+			if (IS_ENABLED(CONFIG_I2C_SCANNER_PROGRESS)) {
+				scan_progress_flush(addr, SCAN_PROGRESS_10BIT);
+			}
+		}
+
+		if (test_i2c_address_10bit(addr) != 0) {
+			continue;
+		}
+
+		// Same grid layout as the 7-bit sweep, printing only the rows
+		// that contain a device
+		if (row_start != (addr & ~0xF)) {
+			if (row_start >= 0) {
+				printk("\n");
+			}
+			row_start = addr & ~0xF;
+			printk("%03X:", row_start);
+		}
+		printk(" %03X", addr);
+		if (IS_ENABLED(CONFIG_I2C_SCANNER_PROGRESS)) {
+			scan_progress_add(addr, SCAN_PROGRESS_10BIT);
+		}
+
+		if (devices_found < max_found) {
+			found[devices_found] = addr;
+		}
+		devices_found++;
+	}
+	if (row_start >= 0) {
+		printk("\n");
+	}
+	if (IS_ENABLED(CONFIG_I2C_SCANNER_PROGRESS)) {
+		scan_progress_flush(I2C_NUM_ADDRS_10BIT, SCAN_PROGRESS_10BIT);
+	}
+
+	// Nothing answering at all is what a controller that fails 10-bit
+	// messages as NACKs reports too, so it is not an empty bus
+	if (method == -EIO && devices_found == 0) {
+		LOG_WRN("10-bit sweep complete. Every probe NACKed, %s may not "
+			"support 10-bit addressing", i2c_dev->name);
+		return -EIO;
+	}
+
+	LOG_INF("10-bit sweep complete. Found %d device(s).", devices_found);
+	return devices_found;
+}
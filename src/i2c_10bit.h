@@ -0,0 +1,22 @@
+// 10-bit I2C address sweep
+
+#ifndef I2C_10BIT_H_
+#define I2C_10BIT_H_
+
+#include <stdint.h>
+
+// Number of 10-bit addresses
+#define I2C_NUM_ADDRS_10BIT 1024
+
+/**
+ * @brief Probe all 1024 10-bit addresses on the scanned bus
+ * @param found Buffer receiving the addresses of responding devices
+ * @param max_found Capacity of @p found
+ * @return Number of devices found (may exceed @p max_found), -ENOTSUP if
+ *         the controller cannot generate 10-bit addresses, or -EIO if every
+ *         probe including the capability probe was NACKed, so support is
+ *         unknown
+ */
+int scan_i2c_bus_10bit(uint16_t *found, int max_found);
+
+#endif /* I2C_10BIT_H_ */
@@ -0,0 +1,283 @@
+// Port-parallel bit-banged I2C scanning
+//
+// Up to CONFIG_I2C_SCANNER_BITBANG_MAX_BUSES SCL/SDA pairs on a single GPIO
+// port are driven in lockstep: every bus sees the same address sequence,
+// all lines change with one gpio_port_set_masked_raw() call and all ACK bits
+// are sampled with one gpio_port_get_raw() call. Sweeping N buses therefore
+// takes the time of one. Lines are open drain: writing 1 releases the line
+// to its pull-up, writing 0 pulls it low.
+//
+// GPIO controllers without open-drain outputs, such as gpio_emul, are driven
+// by switching direction instead (CONFIG_I2C_SCANNER_BITBANG_SWITCH_DIR): a
+// released line is an input, a line pulled low is an output driving low.
+// Lines then change one pin at a time; sampling stays port-wide.
+
+#include <zephyr/kernel.h>
+#include <zephyr/drivers/gpio.h>
+#include <zephyr/logging/log.h>
+#include <string.h>
+
+#include "scanner.h"
+#include "i2c_bitbang.h"
+
+LOG_MODULE_DECLARE(i2c_scanner, LOG_LEVEL_INF);
+
+static inline void half_period(void)
+{
+	k_busy_wait(CONFIG_I2C_SCANNER_BITBANG_HALF_PERIOD_US);
+}
+
+/**
+ * @brief Release (input) or pull low (output low) one line
+ */
+static inline int switch_line(const struct i2c_bitbang_lines *lines, gpio_pin_t pin,
+			      bool release)
+{
+	gpio_flags_t flags = GPIO_OUTPUT_LOW;
+
+	if (release) {
+		flags = GPIO_INPUT | ((lines->pull_up & BIT(pin)) ? GPIO_PULL_UP : 0);
+	}
+	return gpio_pin_configure(lines->port, pin, flags);
+}
+
+static inline void set_lines(const struct i2c_bitbang_lines *lines,
+			     gpio_port_pins_t mask, gpio_port_value_t value)
+{
+	if (IS_ENABLED(CONFIG_I2C_SCANNER_BITBANG_SWITCH_DIR)) {
+		while (mask) {
+			gpio_pin_t pin = find_lsb_set(mask) - 1;
+
+			switch_line(lines, pin, value & BIT(pin));
+			mask &= ~BIT(pin);
+		}
+		return;
+	}
+
+	gpio_port_set_masked_raw(lines->port, mask, value);
+}
+
+/**
+ * @brief Release SCL on all buses and wait for targets to stop stretching
+ */
+static void scl_release(struct i2c_bitbang_lines *lines)
+{
+	gpio_port_pins_t live = lines->scl_mask & ~lines->stuck_scl;
+	gpio_port_value_t val = 0;
+	uint32_t waited = 0;
+
+	set_lines(lines, lines->scl_mask, lines->scl_mask);
+	half_period();
+
+	while (gpio_port_get_raw(lines->port, &val) == 0 && (val & live) != live) {
+		if (waited >= CONFIG_I2C_SCANNER_BITBANG_STRETCH_TIMEOUT_US) {
+			lines->stuck_scl |= ~val & live;
+			break;
+		}
+		k_busy_wait(1);
+		waited++;
+	}
+}
+
+static void bb_start(struct i2c_bitbang_lines *lines)
+{
+	set_lines(lines, lines->sda_mask, lines->sda_mask);
+	scl_release(lines);
+	set_lines(lines, lines->sda_mask, 0);
+	half_period();
+	set_lines(lines, lines->scl_mask, 0);
+	half_period();
+}
+
+static void bb_stop(struct i2c_bitbang_lines *lines)
+{
+	set_lines(lines, lines->sda_mask, 0);
+	half_period();
+	scl_release(lines);
+	set_lines(lines, lines->sda_mask, lines->sda_mask);
+	half_period();
+}
+
+/**
+ * @brief Clock one bit out on all buses, sampling SDA while SCL is high
+ * @param bit Level to put on SDA (1 releases it)
+ * @return SDA levels of all buses while SCL was high
+ */
+static gpio_port_value_t bb_clock_bit(struct i2c_bitbang_lines *lines, bool bit)
+{
+	gpio_port_value_t val = 0;
+
+	set_lines(lines, lines->sda_mask, bit ? lines->sda_mask : 0);
+	half_period();
+	scl_release(lines);
+	gpio_port_get_raw(lines->port, &val);
+	set_lines(lines, lines->scl_mask, 0);
+
+	return val & lines->sda_mask;
+}
+
+gpio_port_pins_t i2c_bitbang_probe(struct i2c_bitbang_lines *lines, uint8_t addr)
+{
+	uint8_t byte = (addr << 1) | 1;
+	gpio_port_pins_t ack;
+
+	bb_start(lines);
+
+	for (int i = 7; i >= 0; i--) {
+		bb_clock_bit(lines, byte & BIT(i));
+	}
+
+	// ACK is a low SDA during the ninth clock
+	ack = ~bb_clock_bit(lines, true) & lines->sda_mask;
+
+	// Clock out the data byte of acknowledging targets, then NACK it
+	for (int i = 0; i < 8; i++) {
+		bb_clock_bit(lines, true);
+	}
+	bb_clock_bit(lines, true);
+
+	bb_stop(lines);
+
+	return ack;
+}
+
+/**
+ * @brief Configure one line as released
+ * @param flags Extra devicetree GPIO flags of the line
+ */
+static int configure_line(struct i2c_bitbang_lines *lines, gpio_pin_t pin,
+			  gpio_dt_flags_t flags)
+{
+	if (IS_ENABLED(CONFIG_I2C_SCANNER_BITBANG_SWITCH_DIR)) {
+		if (flags & GPIO_PULL_UP) {
+			lines->pull_up |= BIT(pin);
+		}
+		return switch_line(lines, pin, true);
+	}
+
+	return gpio_pin_configure(lines->port, pin,
+				  GPIO_INPUT | GPIO_OUTPUT_HIGH | GPIO_OPEN_DRAIN | flags);
+}
+
+int i2c_bitbang_configure_pair(struct i2c_bitbang_lines *lines, gpio_pin_t scl,
+			       gpio_dt_flags_t scl_flags, gpio_pin_t sda,
+			       gpio_dt_flags_t sda_flags)
+{
+	int ret;
+
+	ret = configure_line(lines, scl, scl_flags);
+	if (ret < 0) {
+		return ret;
+	}
+
+	ret = configure_line(lines, sda, sda_flags);
+	if (ret < 0) {
+		return ret;
+	}
+
+	lines->scl_mask |= BIT(scl);
+	lines->sda_mask |= BIT(sda);
+	return 0;
+}
+
+#if defined(CONFIG_I2C_SCANNER_BITBANG)
+#define ZEPHYR_USER_NODE DT_PATH(zephyr_user)
+
+BUILD_ASSERT(DT_NODE_HAS_PROP(ZEPHYR_USER_NODE, bitbang_scl_gpios) &&
+	     DT_NODE_HAS_PROP(ZEPHYR_USER_NODE, bitbang_sda_gpios),
+	     "CONFIG_I2C_SCANNER_BITBANG needs bitbang-scl-gpios and "
+	     "bitbang-sda-gpios in zephyr,user");
+
+BUILD_ASSERT(DT_PROP_LEN(ZEPHYR_USER_NODE, bitbang_scl_gpios) ==
+	     DT_PROP_LEN(ZEPHYR_USER_NODE, bitbang_sda_gpios),
+	     "bitbang-scl-gpios and bitbang-sda-gpios must pair up");
+
+#define NUM_BUSES DT_PROP_LEN(ZEPHYR_USER_NODE, bitbang_scl_gpios)
+
+BUILD_ASSERT(NUM_BUSES <= CONFIG_I2C_SCANNER_BITBANG_MAX_BUSES,
+	     "Too many bit-banged buses");
+
+#define BB_GPIO_SPEC(node, prop, idx) GPIO_DT_SPEC_GET_BY_IDX(node, prop, idx),
+
+static const struct gpio_dt_spec scl_pins[] = {
+	DT_FOREACH_PROP_ELEM(ZEPHYR_USER_NODE, bitbang_scl_gpios, BB_GPIO_SPEC)
+};
+
+static const struct gpio_dt_spec sda_pins[] = {
+	DT_FOREACH_PROP_ELEM(ZEPHYR_USER_NODE, bitbang_sda_gpios, BB_GPIO_SPEC)
+};
+
+// Shared port and line masks of all buses
+static struct i2c_bitbang_lines buses;
+
+int i2c_bitbang_init(void)
+{
+	const struct device *port = scl_pins[0].port;
+	int ret;
+
+	if (!device_is_ready(port)) {
+		LOG_ERR("GPIO device %s not ready!", port->name);
+		return -ENODEV;
+	}
+
+	buses.port = port;
+	for (size_t i = 0; i < NUM_BUSES; i++) {
+		if (scl_pins[i].port != port || sda_pins[i].port != port) {
+			LOG_ERR("Bit-banged bus %d is not on %s", (int)i, port->name);
+			return -EINVAL;
+		}
+
+		ret = i2c_bitbang_configure_pair(&buses, scl_pins[i].pin, scl_pins[i].dt_flags,
+						 sda_pins[i].pin, sda_pins[i].dt_flags);
+		if (ret < 0) {
+			LOG_ERR("Failed to configure bit-banged bus %d: %d", (int)i, ret);
+			return ret;
+		}
+	}
+
+	LOG_INF("%d bit-banged bus(es) on %s", NUM_BUSES, port->name);
+	return 0;
+}
+
+int i2c_bitbang_scan(uint32_t present[][I2C_NUM_ADDRS / 32])
+{
+	int64_t start_ms = k_uptime_get();
+	int total = 0;
+
+	memset(present, 0, NUM_BUSES * sizeof(present[0]));
+	buses.stuck_scl = 0;
+
+	for (uint8_t addr = I2C_SCAN_START; addr <= I2C_SCAN_END; addr++) {
+		gpio_port_pins_t ack = i2c_bitbang_probe(&buses, addr);
+
+		for (size_t i = 0; i < NUM_BUSES; i++) {
+			if (ack & BIT(sda_pins[i].pin)) {
+				present[i][addr / 32] |= BIT(addr % 32);
+				total++;
+			}
+		}
+	}
+
+	for (size_t i = 0; i < NUM_BUSES; i++) {
+		printk("BB%d:", (int)i);
+		if (buses.stuck_scl & BIT(scl_pins[i].pin)) {
+			printk(" SCL stuck low");
+		}
+		for (uint8_t addr = I2C_SCAN_START; addr <= I2C_SCAN_END; addr++) {
+			if (present[i][addr / 32] & BIT(addr % 32)) {
+				printk(" %02X", addr);
+			}
+		}
+		printk("\n");
+	}
+
+	LOG_INF("Bit-banged sweep of %d bus(es): %d device(s) in %u ms", NUM_BUSES,
+		total, (uint32_t)(k_uptime_get() - start_ms));
+	return total;
+}
+
+int i2c_bitbang_num_buses(void)
+{
+	return NUM_BUSES;
+}
+#endif /* CONFIG_I2C_SCANNER_BITBANG */
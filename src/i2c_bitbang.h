@@ -0,0 +1,65 @@
+// Port-parallel bit-banged I2C scanning
+
+#ifndef I2C_BITBANG_H_
+#define I2C_BITBANG_H_
+
+#include <stdint.h>
+#include <zephyr/drivers/gpio.h>
+
+#include "scanner.h"
+
+// Set of bit-banged SCL/SDA pairs on one GPIO port, driven in lockstep
+struct i2c_bitbang_lines {
+	const struct device *port;
+	gpio_port_pins_t scl_mask;
+	gpio_port_pins_t sda_mask;
+	// SCL lines held low past the stretch timeout, ignored afterwards
+	gpio_port_pins_t stuck_scl;
+	// Lines released with the internal pull-up when switching direction
+	gpio_port_pins_t pull_up;
+};
+
+/**
+ * @brief Configure one SCL/SDA pair as released lines and add it to @p lines
+ * @param lines Line set, port must already be set
+ * @param scl SCL pin on lines->port
+ * @param scl_flags Extra devicetree GPIO flags of SCL (e.g. pull-ups)
+ * @param sda SDA pin on lines->port
+ * @param sda_flags Extra devicetree GPIO flags of SDA
+ * @return 0 on success, negative error code otherwise
+ */
+int i2c_bitbang_configure_pair(struct i2c_bitbang_lines *lines, gpio_pin_t scl,
+			       gpio_dt_flags_t scl_flags, gpio_pin_t sda,
+			       gpio_dt_flags_t sda_flags);
+
+/**
+ * @brief Probe one address on all pairs of @p lines with a one byte read
+ * @param lines Line set to drive
+ * @param addr 7-bit address
+ * @return SDA mask of the pairs whose target acknowledged
+ */
+gpio_port_pins_t i2c_bitbang_probe(struct i2c_bitbang_lines *lines, uint8_t addr);
+
+/**
+ * @brief Configure the bit-banged SCL/SDA pairs as open-drain lines
+ *
+ * The pairs come from the bitbang-scl-gpios and bitbang-sda-gpios
+ * properties of the zephyr,user node and must all be on one GPIO port.
+ *
+ * @return 0 on success, negative error code otherwise
+ */
+int i2c_bitbang_init(void);
+
+/**
+ * @brief Sweep all bit-banged buses in lockstep
+ * @param present Receives one address bitmap per bus
+ * @return Total number of devices found on all buses
+ */
+int i2c_bitbang_scan(uint32_t present[][I2C_NUM_ADDRS / 32]);
+
+/**
+ * @brief Number of bit-banged buses declared in devicetree
+ */
+int i2c_bitbang_num_buses(void);
+
+#endif /* I2C_BITBANG_H_ */
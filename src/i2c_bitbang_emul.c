@@ -0,0 +1,150 @@
+// Bit-banged bus model on gpio_emul for native_sim
+//
+// Stands in for the wiring behind the bitbang-scl-gpios/bitbang-sda-gpios
+// pairs of the zephyr,user node: every line has an external pull-up, and one
+// target at BB_EMUL_ADDR sits on the first pair. gpio_emul fires callbacks
+// whenever a watched pin is reconfigured or its output changes, so the model
+// follows the engine's line changes as they happen. A line reads low while
+// the engine drives it low or the target pulls SDA low, and high otherwise.
+// The target decodes START, the address byte and STOP, acknowledges its
+// address and answers reads with 0xFF.
+
+#include <zephyr/kernel.h>
+#include <zephyr/drivers/gpio.h>
+#include <zephyr/drivers/gpio/gpio_emul.h>
+#include <zephyr/init.h>
+
+#define ZEPHYR_USER_NODE DT_PATH(zephyr_user)
+
+// Address acknowledged on the first pair
+#define BB_EMUL_ADDR 0x29
+
+enum bb_emul_state {
+	BB_IDLE,
+	BB_ADDR,        // shifting in the address byte
+	BB_ACK,         // holding SDA low for the acknowledge bit
+	BB_DATA,        // transfer acknowledged, waiting for STOP
+};
+
+struct bb_emul_bus {
+	gpio_pin_t scl;
+	gpio_pin_t sda;
+	bool has_target;
+	bool scl_level;
+	bool sda_level;
+	bool target_low;        // target pulling SDA low
+	enum bb_emul_state state;
+	uint8_t bits;
+	uint8_t byte;
+};
+
+#define BB_EMUL_BUS(node, prop, idx)						\
+	{									\
+		.scl = DT_GPIO_PIN_BY_IDX(node, bitbang_scl_gpios, idx),	\
+		.sda = DT_GPIO_PIN_BY_IDX(node, bitbang_sda_gpios, idx),	\
+		.has_target = (idx) == 0,					\
+		.scl_level = true,						\
+		.sda_level = true,						\
+	},
+
+static struct bb_emul_bus buses[] = {
+	DT_FOREACH_PROP_ELEM(ZEPHYR_USER_NODE, bitbang_scl_gpios, BB_EMUL_BUS)
+};
+
+static const struct device *const port =
+	DEVICE_DT_GET(DT_GPIO_CTLR_BY_IDX(ZEPHYR_USER_NODE, bitbang_scl_gpios, 0));
+
+static struct gpio_callback bb_emul_cb;
+
+/**
+ * @brief Level of a line: low while driven low by the engine or @p pulled
+ */
+static bool line_level(gpio_pin_t pin, bool pulled)
+{
+	gpio_flags_t flags = 0;
+
+	gpio_emul_flags_get(port, pin, &flags);
+	if ((flags & GPIO_OUTPUT) && gpio_emul_output_get(port, pin) == 0) {
+		return false;
+	}
+	return !pulled;
+}
+
+/**
+ * @brief Make a released line read back its level
+ */
+static void line_update(gpio_pin_t pin, bool level)
+{
+	gpio_flags_t flags = 0;
+
+	gpio_emul_flags_get(port, pin, &flags);
+	if (flags & GPIO_INPUT) {
+		gpio_emul_input_set(port, pin, level);
+	}
+}
+
+static void bb_emul_bus_update(struct bb_emul_bus *bus)
+{
+	bool scl = line_level(bus->scl, false);
+	bool sda = line_level(bus->sda, bus->target_low);
+
+	if (scl && bus->scl_level && sda != bus->sda_level) {
+		// SDA changing while SCL is high: START or STOP
+		bus->state = sda ? BB_IDLE : BB_ADDR;
+		bus->bits = 0;
+		bus->byte = 0;
+		bus->target_low = false;
+	} else if (scl && !bus->scl_level) {
+		if (bus->state == BB_ADDR && bus->bits < 8) {
+			bus->byte = (bus->byte << 1) | sda;
+			bus->bits++;
+		}
+	} else if (!scl && bus->scl_level) {
+		if (bus->state == BB_ADDR && bus->bits == 8) {
+			if (bus->has_target && (bus->byte >> 1) == BB_EMUL_ADDR) {
+				bus->target_low = true;
+				bus->state = BB_ACK;
+			} else {
+				bus->state = BB_IDLE;
+			}
+		} else if (bus->state == BB_ACK) {
+			// Released data bits read as 0xFF
+			bus->target_low = false;
+			bus->state = BB_DATA;
+		}
+	}
+
+	sda = line_level(bus->sda, bus->target_low);
+	line_update(bus->scl, scl);
+	line_update(bus->sda, sda);
+	bus->scl_level = scl;
+	bus->sda_level = sda;
+}
+
+static void bb_emul_handler(const struct device *dev, struct gpio_callback *cb,
+			    gpio_port_pins_t pins)
+{
+	for (size_t i = 0; i < ARRAY_SIZE(buses); i++) {
+		if (pins & (BIT(buses[i].scl) | BIT(buses[i].sda))) {
+			bb_emul_bus_update(&buses[i]);
+		}
+	}
+}
+
+static int bb_emul_init(void)
+{
+	gpio_port_pins_t mask = 0;
+
+	if (!device_is_ready(port)) {
+		return -ENODEV;
+	}
+
+	for (size_t i = 0; i < ARRAY_SIZE(buses); i++) {
+		mask |= BIT(buses[i].scl) | BIT(buses[i].sda);
+	}
+
+	gpio_init_callback(&bb_emul_cb, bb_emul_handler, mask);
+	return gpio_add_callback(port, &bb_emul_cb);
+}
+
+SYS_INIT(bb_emul_init, APPLICATION, 0);
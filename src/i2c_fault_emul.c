@@ -0,0 +1,146 @@
+// Fault-injecting I2C target emulator for native_sim
+//
+// Attaches to the emulated I2C controller like any bus emulator and serves a
+// plain register file (the first written byte sets the register pointer,
+// reads auto-increment). Faults are set per node in devicetree: random NACKs
+// from a seeded sequence, slow address ACKs, per-byte clock stretching, a
+// stuck SDA and answering on extra alias addresses. Delays use
+// k_busy_wait(), which advances simulated time on native_sim, so sweep times
+// measured against these targets are reproducible.
+//
+// On the emulated bus every target only sees transfers to its own
+// addresses, so a stuck SDA is modelled as the transfers to the target
+// running into a controller timeout rather than blocking the whole bus.
+
+#define DT_DRV_COMPAT i2c_scanner_fault_emul
+
+#include <zephyr/kernel.h>
+#include <zephyr/device.h>
+#include <zephyr/drivers/emul.h>
+#include <zephyr/drivers/i2c.h>
+#include <zephyr/drivers/i2c_emul.h>
+#include <zephyr/logging/log.h>
+
+LOG_MODULE_DECLARE(i2c_scanner, LOG_LEVEL_INF);
+
+#define FAULT_EMUL_REGS 256
+
+struct fault_emul_cfg {
+	uint8_t nack_percent;
+	uint32_t seed;
+	uint32_t stretch_us;
+	uint32_t slow_ack_us;
+	bool stuck_sda;
+	uint32_t stuck_sda_timeout_us;
+	const uint16_t *aliases;
+	size_t num_aliases;
+};
+
+struct fault_emul_data {
+	struct i2c_emul *alias_emuls;
+	uint32_t rng;
+	uint8_t reg_ptr;
+	uint8_t regs[FAULT_EMUL_REGS];
+};
+
+// xorshift32, enough to spread NACKs and cheap to reproduce
+static uint32_t next_random(struct fault_emul_data *data)
+{
+	uint32_t x = data->rng;
+
+	x ^= x << 13;
+	x ^= x >> 17;
+	x ^= x << 5;
+	data->rng = x;
+	return x;
+}
+
+static int fault_emul_transfer(const struct emul *target, struct i2c_msg *msgs,
+			       int num_msgs, int addr)
+{
+	const struct fault_emul_cfg *cfg = target->cfg;
+	struct fault_emul_data *data = target->data;
+
+	if (cfg->slow_ack_us) {
+		k_busy_wait(cfg->slow_ack_us);
+	}
+
+	if (cfg->stuck_sda) {
+		k_busy_wait(cfg->stuck_sda_timeout_us);
+		return -EIO;
+	}
+
+	if (cfg->nack_percent && (next_random(data) % 100) < cfg->nack_percent) {
+		return -EIO;
+	}
+
+	for (int i = 0; i < num_msgs; i++) {
+		struct i2c_msg *msg = &msgs[i];
+
+		if (cfg->stretch_us) {
+			k_busy_wait(cfg->stretch_us * msg->len);
+		}
+
+		if (msg->flags & I2C_MSG_READ) {
+			for (uint32_t j = 0; j < msg->len; j++) {
+				msg->buf[j] = data->regs[data->reg_ptr++];
+			}
+		} else if (msg->len > 0) {
+			data->reg_ptr = msg->buf[0];
+			for (uint32_t j = 1; j < msg->len; j++) {
+				data->regs[data->reg_ptr++] = msg->buf[j];
+			}
+		}
+	}
+
+	return 0;
+}
+
+static const struct i2c_emul_api fault_emul_api = {
+	.transfer = fault_emul_transfer,
+};
+
+static int fault_emul_init(const struct emul *target, const struct device *parent)
+{
+	const struct fault_emul_cfg *cfg = target->cfg;
+	struct fault_emul_data *data = target->data;
+
+	data->rng = cfg->seed ? cfg->seed : 1;
+
+	for (size_t i = 0; i < cfg->num_aliases; i++) {
+		struct i2c_emul *alias = &data->alias_emuls[i];
+
+		alias->target = target;
+		alias->api = &fault_emul_api;
+		alias->addr = cfg->aliases[i];
+		i2c_emul_register(parent, alias);
+	}
+
+	return 0;
+}
+
+#define NUM_ALIASES(n) DT_INST_PROP_LEN_OR(n, alias_addrs, 0)
+
+#define FAULT_EMUL_DEFINE(n)							\
+	static const uint16_t fault_emul_aliases_##n[MAX(NUM_ALIASES(n), 1)] =	\
+		DT_INST_PROP_OR(n, alias_addrs, {0});				\
+	static struct i2c_emul fault_emul_alias_emuls_##n[MAX(NUM_ALIASES(n), 1)]; \
+	static struct fault_emul_data fault_emul_data_##n = {			\
+		.alias_emuls = fault_emul_alias_emuls_##n,			\
+	};									\
+	static const struct fault_emul_cfg fault_emul_cfg_##n = {		\
+		.nack_percent = DT_INST_PROP(n, nack_percent),			\
+		.seed = DT_INST_PROP(n, seed),					\
+		.stretch_us = DT_INST_PROP(n, stretch_us),			\
+		.slow_ack_us = DT_INST_PROP(n, slow_ack_us),			\
+		.stuck_sda = DT_INST_PROP(n, stuck_sda),			\
+		.stuck_sda_timeout_us = DT_INST_PROP(n, stuck_sda_timeout_us),	\
+		.aliases = fault_emul_aliases_##n,				\
+		.num_aliases = NUM_ALIASES(n),					\
+	};									\
+	DEVICE_DT_INST_DEFINE(n, NULL, NULL, NULL, NULL, POST_KERNEL,		\
+			      CONFIG_KERNEL_INIT_PRIORITY_DEVICE, NULL);	\
+	EMUL_DT_INST_DEFINE(n, fault_emul_init, &fault_emul_data_##n,		\
+			    &fault_emul_cfg_##n, &fault_emul_api, NULL);
+
+DT_INST_FOREACH_STATUS_OKAY(FAULT_EMUL_DEFINE)
@@ -0,0 +1,335 @@
+// I2C switch (TCA9548A/PCA954x) discovery and downstream channel scanning
+//
+// Switches of this family expose a single control register: each bit enables
+// one downstream channel and reads back exactly what was written. Devices on
+// the root bus stay visible on every channel, so they are excluded from the
+// channel sweeps, and the current control value of every switch is cached so
+// a channel is only re-selected when it actually changes. With bus sharing,
+// the bus is held from channel select to deselect, so application transfers
+// never run while a downstream channel is connected to the root bus.
+//
+// Switches declared in devicetree are left out of the walk: their driver
+// caches the selected channel, so writing the control register here would
+// leave the application's transfers on the child buses going out on a closed
+// channel. Undeclared candidates are identified by write/readback once, and a
+// negative result is remembered until the address drops off the bus, so
+// ordinary devices in 0x70-0x77 are not written to on every sweep.
+
+#include <zephyr/kernel.h>
+#include <zephyr/drivers/i2c.h>
+#include <zephyr/logging/log.h>
+
+#include "scanner.h"
+#include "bus_share.h"
+#include "i2c_mux.h"
+
+LOG_MODULE_DECLARE(i2c_scanner, LOG_LEVEL_INF);
+
+// One discovered switch in the bus tree
+struct mux_node {
+	uint8_t addr;
+	uint8_t depth;
+	uint8_t num_channels;
+	uint8_t cur_sel;        // cached control register value
+	int8_t parent;          // index into muxes[], -1 for the root bus
+	uint8_t parent_channel;
+};
+
+// Address bitmap covering the 7-bit address space
+struct addr_map {
+	uint32_t bits[I2C_NUM_ADDRS / 32];
+};
+
+// Read-only interrupt status bits of the PCA9543 (INT0-1) and PCA9545 (INT0-3)
+#define PCA9543_INT_MASK 0x30
+#define PCA9545_INT_MASK 0xF0
+
+#define MUX_ADDR_BIT(addr) BIT((addr) - I2C_MUX_ADDR_FIRST)
+
+#define I2C_SCAN_NODE DT_CHOSEN(i2c_scanner_bus)
+
+#define MUX_DECL(node)								\
+	COND_CODE_1(UTIL_OR(DT_NODE_HAS_COMPAT(node, ti_tca9548a),		\
+			    DT_NODE_HAS_COMPAT(node, ti_tca9546a)),		\
+		(DT_REG_ADDR(node),), ())
+
+// Switches declared as direct children of the scanned bus
+static const uint8_t declared_muxes[] = {
+	DT_FOREACH_CHILD_STATUS_OKAY(I2C_SCAN_NODE, MUX_DECL)
+};
+
+static struct mux_node muxes[CONFIG_I2C_SCANNER_MUX_MAX];
+static int num_muxes;
+static int channel_switches;
+
+// Candidates already identified as ordinary devices, and the candidates seen
+// during the current walk; both indexed by MUX_ADDR_BIT()
+static uint8_t not_mux;
+static uint8_t seen_candidates;
+
+static inline void addr_map_set(struct addr_map *map, uint8_t addr)
+{
+	map->bits[addr / 32] |= BIT(addr % 32);
+}
+
+static inline bool addr_map_test(const struct addr_map *map, uint8_t addr)
+{
+	return (map->bits[addr / 32] & BIT(addr % 32)) != 0;
+}
+
+/**
+ * @brief Write the switch control register unless it already holds @p sel
+ * @param mux Switch to update
+ * @param sel Channel enable mask
+ * @return 0 on success, negative error code otherwise
+ */
+static int mux_select(struct mux_node *mux, uint8_t sel)
+{
+	int ret;
+
+	if (mux->cur_sel == sel) {
+		return 0;
+	}
+
+	ret = i2c_write(i2c_dev, &sel, 1, mux->addr);
+	if (ret < 0) {
+		LOG_ERR("Mux 0x%02X select 0x%02X failed: %d", mux->addr, sel, ret);
+		return ret;
+	}
+
+	mux->cur_sel = sel;
+	channel_switches++;
+	return 0;
+}
+
+/**
+ * @brief Write a control value and read it back
+ * @return Value read back, or negative error code
+ */
+static int mux_write_readback(uint8_t addr, uint8_t val)
+{
+	uint8_t rb;
+	int ret;
+
+	ret = i2c_write(i2c_dev, &val, 1, addr);
+	if (ret < 0) {
+		return ret;
+	}
+
+	ret = i2c_read(i2c_dev, &rb, 1, addr);
+	if (ret < 0) {
+		return ret;
+	}
+
+	return rb;
+}
+
+/**
+ * @brief Check whether a switch is declared in devicetree at @p addr
+ */
+static bool mux_is_declared(uint8_t addr)
+{
+	for (size_t i = 0; i < ARRAY_SIZE(declared_muxes); i++) {
+		if (declared_muxes[i] == addr) {
+			return true;
+		}
+	}
+
+	return false;
+}
+
+/**
+ * @brief Check whether the device at @p addr behaves like a PCA954x switch
+ *
+ * Enabling all channels reads back a mask of the implemented channels
+ * (0x03, 0x0F or 0xFF); disabling them must read back zero. The PCA9543 and
+ * PCA9545 report pending interrupts in the upper nibble, so those bits are
+ * masked off before comparing. The switch is left with all channels disabled.
+ *
+ * @param addr Address of the candidate device
+ * @return Number of channels, or 0 if the device is not a switch
+ */
+static int mux_detect(uint8_t addr)
+{
+	int all, none;
+
+	all = mux_write_readback(addr, 0xFF);
+	none = mux_write_readback(addr, 0x00);
+	if (all < 0 || none < 0) {
+		return 0;
+	}
+
+	if (all == 0xFF && none == 0) {
+		return 8;
+	}
+
+	if ((all & ~PCA9545_INT_MASK) == 0x0F && (none & ~PCA9545_INT_MASK) == 0) {
+		return 4;
+	}
+
+	if ((all & ~PCA9543_INT_MASK) == 0x03 && (none & ~PCA9543_INT_MASK) == 0) {
+		return 2;
+	}
+
+	return 0;
+}
+
+/**
+ * @brief Register a newly detected switch in the tree
+ * @return Index into muxes[], or -1 if the table is full or not a switch
+ */
+static int mux_add(uint8_t addr, int parent, uint8_t parent_channel)
+{
+	int channels;
+	struct mux_node *mux;
+
+	if (num_muxes >= CONFIG_I2C_SCANNER_MUX_MAX) {
+		LOG_WRN("Mux table full, not descending into 0x%02X", addr);
+		return -1;
+	}
+
+	seen_candidates |= MUX_ADDR_BIT(addr);
+
+	if (mux_is_declared(addr)) {
+		printk("%*sMux 0x%02X (declared, channels owned by its driver)\n",
+		       2 * ((parent < 0) ? 1 : muxes[parent].depth + 2), "", addr);
+		return -1;
+	}
+
+	if (not_mux & MUX_ADDR_BIT(addr)) {
+		return -1;
+	}
+
+	channels = mux_detect(addr);
+	if (channels == 0) {
+		not_mux |= MUX_ADDR_BIT(addr);
+		return -1;
+	}
+
+	mux = &muxes[num_muxes];
+	mux->addr = addr;
+	mux->depth = (parent < 0) ? 0 : muxes[parent].depth + 1;
+	mux->num_channels = channels;
+	mux->cur_sel = 0;
+	mux->parent = parent;
+	mux->parent_channel = parent_channel;
+
+	printk("%*sMux 0x%02X (%d channels)\n", 2 * (mux->depth + 1), "",
+	       addr, channels);
+
+	return num_muxes++;
+}
+
+/**
+ * @brief Sweep every channel of a switch and recurse into nested switches
+ * @param idx Index of the switch in muxes[]
+ * @param upstream Addresses visible on the path to this switch
+ * @return Number of devices found behind this switch
+ */
+static int mux_walk(int idx, const struct addr_map *upstream)
+{
+	struct mux_node *mux = &muxes[idx];
+	int found = 0;
+
+	for (uint8_t ch = 0; ch < mux->num_channels; ch++) {
+		struct addr_map visible = *upstream;
+		uint8_t children[I2C_MUX_ADDR_LAST - I2C_MUX_ADDR_FIRST + 1];
+		int num_children = 0;
+
+		if (IS_ENABLED(CONFIG_I2C_SCANNER_SHARE)) {
+			bus_share_probe_begin();
+		}
+
+		if (mux_select(mux, BIT(ch)) < 0) {
+			if (IS_ENABLED(CONFIG_I2C_SCANNER_SHARE)) {
+				bus_share_probe_end();
+			}
+			break;
+		}
+
+		printk("%*sch%d: ", 2 * (mux->depth + 2), "", ch);
+
+		for (uint8_t addr = I2C_SCAN_START; addr <= I2C_SCAN_END; addr++) {
+			// Upstream devices and the switch itself show up on
+			// every channel, only probe what could be new here
+			if (addr_map_test(upstream, addr) || addr == mux->addr) {
+				continue;
+			}
+
+			if (test_i2c_address(addr) != 0) {
+				continue;
+			}
+
+			printk("%02X ", addr);
+			addr_map_set(&visible, addr);
+			found++;
+
+			if (addr >= I2C_MUX_ADDR_FIRST && addr <= I2C_MUX_ADDR_LAST &&
+			    mux->depth + 1 < CONFIG_I2C_SCANNER_MUX_MAX_DEPTH) {
+				children[num_children++] = addr;
+			}
+		}
+		printk("\n");
+
+		// Nested switches are walked while this channel is still
+		// selected, everything seen so far counts as upstream for them
+		addr_map_set(&visible, mux->addr);
+		for (int i = 0; i < num_children; i++) {
+			int child = mux_add(children[i], idx, ch);
+
+			if (child >= 0) {
+				found += mux_walk(child, &visible);
+			}
+		}
+
+		if (IS_ENABLED(CONFIG_I2C_SCANNER_SHARE)) {
+			// Disconnect the channel before handing the bus back
+			mux_select(mux, 0);
+			bus_share_probe_end();
+		}
+	}
+
+	mux_select(mux, 0);
+	return found;
+}
+
+int i2c_mux_scan_tree(const uint8_t root_state[I2C_NUM_ADDRS])
+{
+	struct addr_map root = { 0 };
+	int found = 0;
+
+	num_muxes = 0;
+	channel_switches = 0;
+	seen_candidates = 0;
+
+	for (uint8_t addr = I2C_SCAN_START; addr <= I2C_SCAN_END; addr++) {
+		if (root_state[addr] == PROBE_PRESENT) {
+			addr_map_set(&root, addr);
+		}
+	}
+
+	printk("Bus tree:\n  root\n");
+
+	for (uint8_t addr = I2C_MUX_ADDR_FIRST; addr <= I2C_MUX_ADDR_LAST; addr++) {
+		int idx;
+
+		if (!addr_map_test(&root, addr)) {
+			continue;
+		}
+
+		idx = mux_add(addr, -1, 0);
+		if (idx >= 0) {
+			found += mux_walk(idx, &root);
+		}
+	}
+
+	// A candidate that left the bus may come back as a different device
+	not_mux &= seen_candidates;
+
+	if (num_muxes > 0) {
+		LOG_INF("Mux scan: %d mux(es), %d downstream device(s), %d channel switch(es)",
+			num_muxes, found, channel_switches);
+	}
+
+	return found;
+}
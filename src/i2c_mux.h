@@ -0,0 +1,33 @@
+// I2C switch (TCA9548A/PCA954x) discovery and downstream channel scanning
+
+#ifndef I2C_MUX_H_
+#define I2C_MUX_H_
+
+#include <stdint.h>
+
+#include "scanner.h"
+
+// Address range used by the PCA954x/TCA954x switch family
+#define I2C_MUX_ADDR_FIRST 0x70
+#define I2C_MUX_ADDR_LAST  0x77
+
+#if defined(CONFIG_I2C_SCANNER_MUX)
+/**
+ * @brief Detect switches among the root bus devices and scan their channels
+ *
+ * Walks every switch found on the root bus depth-first, printing the bus tree
+ * (root -> switch -> channel -> devices). All switch channels are disabled
+ * again when the walk completes, so the root bus sees only its own devices.
+ *
+ * @param root_state Probe state of the root bus from the preceding sweep
+ * @return Number of devices found behind switches
+ */
+int i2c_mux_scan_tree(const uint8_t root_state[I2C_NUM_ADDRS]);
+#else
+static inline int i2c_mux_scan_tree(const uint8_t root_state[I2C_NUM_ADDRS])
+{
+	return 0;
+}
+#endif
+
+#endif /* I2C_MUX_H_ */
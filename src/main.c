@@ -6,49 +6,108 @@
 #include <zephyr/drivers/i2c.h>
 #include <zephyr/drivers/gpio.h>
 #include <zephyr/logging/log.h>
+#include <zephyr/sys/byteorder.h>
 #include <string.h>
 
+#if defined(CONFIG_SHELL)
+#include <zephyr/shell/shell.h>
+#endif
+
+#include "scanner.h"
+#include "i2c_mux.h"
+#include "i2c_10bit.h"
+#include "smbus_special.h"
+#include "smbus_alert.h"
+#include "pmbus_telemetry.h"
+#include "eeprom.h"
+#include "i2c_bitbang.h"
+#include "pin_discovery.h"
+#include "probe_vote.h"
+#include "presence_stats.h"
+#include "scan_cadence.h"
+#include "bus_share.h"
+#include "scan_progress.h"
+#include "host_target.h"
+#include "mesh_inventory.h"
+#include "fifo_rate.h"
+#include "scan_result.h"
+
+#if defined(CONFIG_BT)
 #include <zephyr/bluetooth/bluetooth.h>
 #include <zephyr/bluetooth/hci.h>
 #include <zephyr/bluetooth/conn.h>
 #include <zephyr/bluetooth/uuid.h>
 #include <zephyr/bluetooth/gatt.h>
+#endif
 
 LOG_MODULE_REGISTER(i2c_scanner, LOG_LEVEL_INF);
 
-// Get I2C device from devicetree
-const struct device *i2c_dev = DEVICE_DT_GET(DT_NODELABEL(i2c21));
+// Scanned I2C bus, selected per board via the "i2c-scanner,bus" chosen node
+#define I2C_SCAN_NODE DT_CHOSEN(i2c_scanner_bus)
+const struct device *i2c_dev = DEVICE_DT_GET(I2C_SCAN_NODE);
 
-// GPIO configuration for pins 1.08, 1.15 and 2.10
-const struct device *gpio_2dev = DEVICE_DT_GET(DT_NODELABEL(gpio2));
-const struct device *gpio_1dev = DEVICE_DT_GET(DT_NODELABEL(gpio1));
-#define GPIO_PIN_8  8
-#define GPIO_PIN_15  15
-#define GPIO_PIN_10 10
+// Optional power-rail GPIOs from the zephyr,user node. Each entry is driven to
+// its active level before scanning; polarity is encoded in the GPIO flags.
+#define ZEPHYR_USER_NODE DT_PATH(zephyr_user)
 
-// I2C address range to scan
-// Addresses 0x00-0x07 and 0x78-0x7F are reserved
-#define I2C_SCAN_START  0x08
-#define I2C_SCAN_END    0x77
+#if DT_NODE_HAS_PROP(ZEPHYR_USER_NODE, power_gpios)
+#define POWER_GPIO_SPEC(node, prop, idx) GPIO_DT_SPEC_GET_BY_IDX(node, prop, idx),
 
-#define MAX_FOUND_DEVICES 10
+static const struct gpio_dt_spec power_gpios[] = {
+	DT_FOREACH_PROP_ELEM(ZEPHYR_USER_NODE, power_gpios, POWER_GPIO_SPEC)
+};
+#else
+static const struct gpio_dt_spec power_gpios[] = {};
+#endif
+
+#define NUM_POWER_GPIOS (sizeof(power_gpios) / sizeof(power_gpios[0]))
+
+#define MAX_FOUND_DEVICES SCAN_RESULT_MAX_ADDRS
 
-// BLE UUIDs - Custom service for I2C Scanner
-#define BT_UUID_I2C_SCANNER_SERVICE_VAL \
-	BT_UUID_128_ENCODE(0x12345678, 0x1234, 0x5678, 0x1234, 0x56789abcdef0)
-#define BT_UUID_I2C_SCAN_RESULT_VAL \
-	BT_UUID_128_ENCODE(0x12345678, 0x1234, 0x5678, 0x1234, 0x56789abcdef1)
+// Addresses of all enabled devicetree children of the scanned bus, generated at
+// build time. These are probed first so the inventory of expected parts is
+// known after a handful of transactions, before the blind sweep starts.
+#define DECLARED_ADDR(node) \
+	COND_CODE_1(DT_NODE_HAS_PROP(node, reg), (DT_REG_ADDR(node),), ())
 
-#define BT_UUID_I2C_SCANNER_SERVICE BT_UUID_DECLARE_128(BT_UUID_I2C_SCANNER_SERVICE_VAL)
-#define BT_UUID_I2C_SCAN_RESULT     BT_UUID_DECLARE_128(BT_UUID_I2C_SCAN_RESULT_VAL)
+static const uint8_t declared_addrs[] = {
+	DT_FOREACH_CHILD_STATUS_OKAY(I2C_SCAN_NODE, DECLARED_ADDR)
+};
 
-// Structure to hold I2C scan results for BLE
-struct i2c_scan_result {
-	uint8_t device_count;
-	uint8_t addresses[MAX_FOUND_DEVICES];
-} __packed;
+#define NUM_DECLARED_ADDRS (sizeof(declared_addrs) / sizeof(declared_addrs[0]))
+
+#if defined(CONFIG_I2C_SCANNER_LIKELY_FIRST)
+// Default addresses of widespread parts, probed right after the previously
+// seen and declared ones: accelerometers and magnetometers (0x1D, 0x1E),
+// I/O expanders and LCD backpacks (0x20, 0x27), OLED controllers (0x3C,
+// 0x3D), current and humidity sensors (0x40, 0x44), temperature sensors and
+// ADCs (0x48), EEPROMs (0x50), pulse oximeters (0x57), RTCs and IMUs (0x68,
+// 0x69) and pressure sensors (0x76, 0x77)
+static const uint8_t popular_addrs[] = {
+	0x1D, 0x1E, 0x20, 0x27, 0x3C, 0x3D, 0x40, 0x44,
+	0x48, 0x50, 0x57, 0x68, 0x69, 0x76, 0x77,
+};
+#endif
 
 static struct i2c_scan_result scan_result;
+
+// Address bitmap of the last sweep, to tell whether the bus changed
+static uint32_t last_present[I2C_NUM_ADDRS / 32];
+
+#if defined(CONFIG_I2C_SCANNER_BITBANG)
+// Address bitmaps of the bit-banged buses from the last sweep, reported on
+// the console only (BLE and the host target carry the main bus)
+static uint32_t bitbang_present[CONFIG_I2C_SCANNER_BITBANG_MAX_BUSES][I2C_NUM_ADDRS / 32];
+#endif
+static bool bitbang_ready;
+
+#if defined(CONFIG_SHELL)
+// "i2cscan" shell command, modules add their subcommands with SHELL_SUBCMD_ADD
+SHELL_SUBCMD_SET_CREATE(sub_i2cscan, (i2cscan));
+SHELL_CMD_REGISTER(i2cscan, &sub_i2cscan, "I2C scanner commands", NULL);
+#endif
+
+#if defined(CONFIG_BT)
 static bool ble_connected = false;
 
 // BLE advertising data
@@ -90,6 +149,11 @@ static void connected(struct bt_conn *conn, uint8_t err)
 	}
 	LOG_INF("BLE Connected");
 	ble_connected = true;
+
+	// Give the new client fresh results
+	if (IS_ENABLED(CONFIG_I2C_SCANNER_CADENCE)) {
+		scan_cadence_kick();
+	}
 }
 
 static void disconnected(struct bt_conn *conn, uint8_t reason)
@@ -126,6 +190,15 @@ static int ble_init(void)
 
 	LOG_INF("Bluetooth initialized");
 
+	// Mesh restores the stored settings, which also completes the
+	// Bluetooth identity setup that advertising waits for
+	if (IS_ENABLED(CONFIG_I2C_SCANNER_MESH)) {
+		err = mesh_inventory_init();
+		if (err) {
+			return err;
+		}
+	}
+
 	err = bt_le_adv_start(BT_LE_ADV_CONN, ad, ARRAY_SIZE(ad), sd, ARRAY_SIZE(sd));
 	if (err) {
 		LOG_ERR("Advertising failed to start (err %d)", err);
@@ -133,30 +206,255 @@ static int ble_init(void)
 	}
 
 	LOG_INF("Advertising started as '%s'", CONFIG_BT_DEVICE_NAME);
+
+	return 0;
+}
+#else
+// Boards without a Bluetooth controller only report over the console
+static void notify_scan_results(void)
+{
+}
+
+static int ble_init(void)
+{
+	LOG_INF("Bluetooth disabled, reporting on console only");
 	return 0;
 }
+#endif /* CONFIG_BT */
 
 /**
  * @brief Test if a device exists at the given I2C address
  * @param addr I2C address to test
  * @return 0 if device found, negative error code otherwise
  */
-static int test_i2c_address(uint8_t addr) {
+int test_i2c_address(uint8_t addr) {
 	uint8_t dummy_data;
+	int ret;
+
+	if (IS_ENABLED(CONFIG_I2C_SCANNER_SHARE)) {
+		bus_share_probe_begin();
+	}
+
 	// Try to read one byte from the device
 	// Most I2C devices will ACK their address even with a simple read
-	return i2c_read(i2c_dev, &dummy_data, 1, addr);
+	ret = i2c_read(i2c_dev, &dummy_data, 1, addr);
+
+	if (IS_ENABLED(CONFIG_I2C_SCANNER_SHARE)) {
+		bus_share_probe_end();
+	}
+
+	return ret;
+}
+
+/**
+ * @brief Probe an address for the sweep, resolving flaky results by voting
+ * @param addr I2C address to test
+ * @return PROBE_PRESENT or PROBE_ABSENT
+ */
+static uint8_t probe_address(uint8_t addr) {
+	bool present = test_i2c_address(addr) == 0;
+
+	if (IS_ENABLED(CONFIG_I2C_SCANNER_VOTING)) {
+		present = probe_vote_resolve(addr, present);
+	}
+
+	return present ? PROBE_PRESENT : PROBE_ABSENT;
+}
+
+/**
+ * @brief Check whether an address is declared as a child of the scanned bus
+ * @param addr I2C address to look up
+ * @return true if the address is in the devicetree-generated table
+ */
+static bool is_declared_address(uint8_t addr) {
+	for (size_t i = 0; i < NUM_DECLARED_ADDRS; i++) {
+		if (declared_addrs[i] == addr) {
+			return true;
+		}
+	}
+	return false;
+}
+
+/**
+ * @brief Probe an address ahead of the sweep, unless already probed
+ * @param state Per-address probe state
+ * @param addr I2C address to test
+ */
+static void probe_ahead(uint8_t state[I2C_NUM_ADDRS], uint8_t addr) {
+	if (addr < I2C_SCAN_START || addr > I2C_SCAN_END ||
+	    state[addr] != PROBE_UNKNOWN) {
+		return;
+	}
+
+	state[addr] = probe_address(addr);
+	if (IS_ENABLED(CONFIG_I2C_SCANNER_PROGRESS) && state[addr] == PROBE_PRESENT) {
+		scan_progress_add(addr, 0);
+	}
+}
+
+/**
+ * @brief Probe the devicetree-declared addresses ahead of the full sweep
+ * @param state Per-address probe state, updated for each declared address
+ * @return Number of declared devices that did not respond
+ */
+static int probe_declared_devices(uint8_t state[I2C_NUM_ADDRS]) {
+	int missing = 0;
+
+	for (size_t i = 0; i < NUM_DECLARED_ADDRS; i++) {
+		uint8_t addr = declared_addrs[i];
+
+		if (addr < I2C_SCAN_START || addr > I2C_SCAN_END) {
+			continue;
+		}
+
+		probe_ahead(state, addr);
+		if (state[addr] == PROBE_PRESENT) {
+			LOG_INF("Declared device 0x%02X present", addr);
+		} else {
+			LOG_WRN("Declared device 0x%02X not responding", addr);
+			missing++;
+		}
+	}
+
+	return missing;
+}
+
+#if defined(CONFIG_I2C_SCANNER_LIKELY_FIRST)
+/**
+ * @brief Probe the addresses that answered in the previous sweep
+ * @param state Per-address probe state
+ */
+static void probe_previously_seen(uint8_t state[I2C_NUM_ADDRS]) {
+	for (uint8_t addr = I2C_SCAN_START; addr <= I2C_SCAN_END; addr++) {
+		if (last_present[addr / 32] & BIT(addr % 32)) {
+			probe_ahead(state, addr);
+		}
+	}
+}
+
+/**
+ * @brief Probe the default addresses of common parts
+ * @param state Per-address probe state
+ */
+static void probe_popular_addresses(uint8_t state[I2C_NUM_ADDRS]) {
+	for (size_t i = 0; i < ARRAY_SIZE(popular_addrs); i++) {
+		probe_ahead(state, popular_addrs[i]);
+	}
+}
+#endif
+
+#if defined(CONFIG_I2C_SCANNER_EARLY_EXIT)
+/**
+ * @brief Check whether the expected device set is confirmed
+ *
+ * True when every declared device answered, no undeclared device did, and
+ * every address present in the previous sweep has been probed again, so the
+ * addresses left unprobed are known to have been empty last time.
+ *
+ * @param state Per-address probe state
+ * @return true if the expected device set is confirmed
+ */
+static bool expected_set_confirmed(const uint8_t state[I2C_NUM_ADDRS]) {
+	if (NUM_DECLARED_ADDRS == 0) {
+		return false;
+	}
+
+	for (size_t i = 0; i < NUM_DECLARED_ADDRS; i++) {
+		uint8_t addr = declared_addrs[i];
+
+		if (addr >= I2C_SCAN_START && addr <= I2C_SCAN_END &&
+		    state[addr] != PROBE_PRESENT) {
+			return false;
+		}
+	}
+
+	for (uint8_t addr = I2C_SCAN_START; addr <= I2C_SCAN_END; addr++) {
+		if (state[addr] == PROBE_PRESENT && !is_declared_address(addr)) {
+			return false;
+		}
+		if (state[addr] == PROBE_UNKNOWN &&
+		    (last_present[addr / 32] & BIT(addr % 32))) {
+			return false;
+		}
+	}
+
+	return true;
 }
 
+/**
+ * @brief Check whether a sweep may stop before reaching the last address
+ * @param state Per-address probe state
+ * @param spot_checks Number of undeclared addresses probed so far
+ * @return true once the expected set is confirmed and enough other
+ *         addresses have been spot-checked
+ */
+static bool early_exit_reached(const uint8_t state[I2C_NUM_ADDRS], int spot_checks) {
+	return spot_checks >= CONFIG_I2C_SCANNER_EARLY_EXIT_SPOT_CHECKS &&
+	       expected_set_confirmed(state);
+}
+#else
+static bool early_exit_reached(const uint8_t state[I2C_NUM_ADDRS], int spot_checks) {
+	return false;
+}
+#endif
+
 /**
  * @brief Scan all I2C addresses and report devices found
+ *
+ * Devicetree-declared addresses are probed first; the remaining addresses are
+ * swept afterwards, reusing the results already obtained for declared ones.
+ *
+ * @return true if the set of devices on the root bus changed since the
+ *         previous sweep
  */
-static void scan_i2c_bus(void) {
+static bool scan_i2c_bus(void) {
 	int devices_found = 0;
+	int count_10bit = 0;
+	int declared_missing;
+	uint16_t found_10bit[MAX_FOUND_DEVICES];
+	uint8_t state[I2C_NUM_ADDRS] = { PROBE_UNKNOWN };
+	uint32_t present[I2C_NUM_ADDRS / 32] = { 0 };
+	bool changed;
+	bool early_exit = false;
+	int spot_checks = 0;
+	uint32_t sweep_ms;
+	int64_t start_ms = k_uptime_get();
 
 	// Clear previous scan results
 	memset(&scan_result, 0, sizeof(scan_result));
 
+	if (IS_ENABLED(CONFIG_I2C_SCANNER_PROGRESS)) {
+		scan_progress_begin();
+	}
+
+	// Likely addresses first: previously seen devices, declared devices,
+	// then the defaults of common parts
+#if defined(CONFIG_I2C_SCANNER_LIKELY_FIRST)
+	probe_previously_seen(state);
+#endif
+	LOG_INF("Checking %d declared device(s)...", (int)NUM_DECLARED_ADDRS);
+	declared_missing = probe_declared_devices(state);
+#if defined(CONFIG_I2C_SCANNER_LIKELY_FIRST)
+	probe_popular_addresses(state);
+#endif
+	if (IS_ENABLED(CONFIG_I2C_SCANNER_PROGRESS)) {
+		scan_progress_flush(I2C_SCAN_START, 0);
+	}
+
+	if (IS_ENABLED(CONFIG_I2C_SCANNER_SMBUS_SPECIAL)) {
+		smbus_probe_special(state);
+	}
+
+	// Undeclared addresses probed so far count as spot checks
+	if (IS_ENABLED(CONFIG_I2C_SCANNER_EARLY_EXIT)) {
+		for (uint8_t addr = I2C_SCAN_START; addr <= I2C_SCAN_END; addr++) {
+			if (state[addr] != PROBE_UNKNOWN && !is_declared_address(addr)) {
+				spot_checks++;
+			}
+		}
+		early_exit = early_exit_reached(state, spot_checks);
+	}
+
 	LOG_INF("Scanning I2C bus...");
 	LOG_INF("     0  1  2  3  4  5  6  7  8  9  A  B  C  D  E  F");
 
@@ -172,11 +470,34 @@ static void scan_i2c_bus(void) {
 				continue;
 			}
 
-			// Test if device responds at this address
-			if (test_i2c_address(addr) == 0) {
+			// Addresses left after an early exit are not probed
+			if (state[addr] == PROBE_UNKNOWN && early_exit) {
+				printk(".. ");
+				continue;
+			}
+
+			// Test if device responds at this address, unless it
+			// was already probed as a declared device
+			if (state[addr] == PROBE_UNKNOWN) {
+				state[addr] = probe_address(addr);
+				if (IS_ENABLED(CONFIG_I2C_SCANNER_PROGRESS) &&
+				    state[addr] == PROBE_PRESENT) {
+					scan_progress_add(addr, 0);
+				}
+				if (IS_ENABLED(CONFIG_I2C_SCANNER_EARLY_EXIT)) {
+					spot_checks++;
+					early_exit = early_exit_reached(state, spot_checks);
+				}
+			}
+
+			if (state[addr] == PROBE_PRESENT) {
 				printk("%02X ", addr);
+				present[addr / 32] |= BIT(addr % 32);
 				if (devices_found < MAX_FOUND_DEVICES) {
 					scan_result.addresses[devices_found] = addr;
+					if (is_declared_address(addr)) {
+						scan_result.declared_mask |= BIT(devices_found);
+					}
 				}
 				devices_found++;
 			} else {
@@ -184,81 +505,141 @@ static void scan_i2c_bus(void) {
 			}
 		}
 		printk("\n");
+
+		// Publish this row's devices without waiting for the sweep
+		if (IS_ENABLED(CONFIG_I2C_SCANNER_PROGRESS)) {
+			scan_progress_flush((row + 1) * 16, 0);
+		}
+	}
+
+	// 10-bit devices are swept after the 7-bit ones, unless the expected
+	// set was already confirmed, and counted in the same report
+	if (IS_ENABLED(CONFIG_I2C_SCANNER_10BIT) && !early_exit) {
+		int ret = scan_i2c_bus_10bit(found_10bit, MAX_FOUND_DEVICES);
+
+		if (ret >= 0) {
+			count_10bit = ret;
+			scan_result.flags |= SCAN_RESULT_10BIT;
+			scan_result.count_10bit = MIN(count_10bit, UINT8_MAX);
+		} else if (ret == -EIO) {
+			scan_result.flags |= SCAN_RESULT_10BIT_UNKNOWN;
+		}
 	}
 
 	// Update scan result count (cap at MAX_FOUND_DEVICES for BLE)
 	scan_result.device_count = (devices_found > MAX_FOUND_DEVICES) ?
 				    MAX_FOUND_DEVICES : devices_found;
 
-	LOG_INF("Scan complete. Found %d device(s).", devices_found);
-	for (int i = 0; i < scan_result.device_count; i++) {
-		LOG_INF("Device[%d] -> 0x%02X", i, scan_result.addresses[i]);
+	scan_result.complete_us =
+		sys_cpu_to_le32((uint32_t)k_ticks_to_us_floor64(k_uptime_ticks()));
+	LOG_INF("Scan complete. Found %d device(s), %d declared missing.",
+		devices_found + count_10bit, declared_missing);
+	sweep_ms = k_uptime_get() - start_ms;
+	LOG_INF("Sweep time: %u ms", sweep_ms);
+	if (early_exit) {
+		scan_result.flags |= SCAN_RESULT_EARLY_EXIT;
+		LOG_INF("Complete by early exit: expected set confirmed after %d spot check(s)",
+			spot_checks);
 	}
 
-	// Notify BLE clients with updated scan results
-	notify_scan_results();
-	LOG_INF("BLE notification sent: %d devices", scan_result.device_count);
-}
+	// Statistics first, the host register map carries them too
+	if (IS_ENABLED(CONFIG_I2C_SCANNER_STATS)) {
+		presence_stats_update(state);
+	}
 
-int main(void) {
-	int ret;
+	if (IS_ENABLED(CONFIG_I2C_SCANNER_TARGET)) {
+		host_target_publish(present, devices_found, scan_result.flags,
+				    declared_missing, sweep_ms);
+	}
 
-	// Check if GPIO device is ready
-	if (!device_is_ready(gpio_2dev)) {
-		LOG_ERR("GPIO device not ready!");
-		return -1;
+	changed = memcmp(present, last_present, sizeof(present)) != 0;
+	if (IS_ENABLED(CONFIG_I2C_SCANNER_MESH) && changed) {
+		mesh_inventory_update(present, last_present);
 	}
-	if (!device_is_ready(gpio_1dev)) {
-		LOG_ERR("GPIO device not ready!");
-		return -1;
+	memcpy(last_present, present, sizeof(present));
+	for (int i = 0; i < scan_result.device_count; i++) {
+		uint8_t addr = scan_result.addresses[i];
+
+		if (IS_ENABLED(CONFIG_I2C_SCANNER_VOTING)) {
+			LOG_INF("Device[%d] -> 0x%02X%s, confidence %d%%", i, addr,
+				(scan_result.declared_mask & BIT(i)) ? " (declared)" : "",
+				probe_vote_confidence(addr));
+		} else {
+			LOG_INF("Device[%d] -> 0x%02X%s", i, addr,
+				(scan_result.declared_mask & BIT(i)) ? " (declared)" : "");
+		}
+	}
+	for (int i = 0; i < MIN(count_10bit, MAX_FOUND_DEVICES); i++) {
+		LOG_INF("Device[%d] -> 0x%03X (10-bit)", devices_found + i,
+			found_10bit[i]);
 	}
 
-
-	// Configure GPIO pin 1.08 as output and set it high
-	ret = gpio_pin_configure(gpio_1dev, GPIO_PIN_8, GPIO_OUTPUT_INACTIVE);
-	if (ret < 0) {
-		LOG_ERR("Failed to configure GPIO pin %d: %d", GPIO_PIN_8, ret);
-		return ret;
+	if (IS_ENABLED(CONFIG_I2C_SCANNER_SMBUS_SPECIAL)) {
+		i2c_read_device_ids(state);
 	}
 
-	ret = gpio_pin_set(gpio_1dev, GPIO_PIN_8, 0);
-	if (ret < 0) {
-		LOG_ERR("Failed to set GPIO pin %d high: %d", GPIO_PIN_8, ret);
-		return ret;
+	if (IS_ENABLED(CONFIG_I2C_SCANNER_PMBUS)) {
+		pmbus_telemetry_discover(state);
 	}
 
-	LOG_INF("GPIO 1.08 set HIGH");
+	if (IS_ENABLED(CONFIG_I2C_SCANNER_EEPROM)) {
+		eeprom_discover(state);
+	}
 
-	// Configure GPIO pin 1.15 as output and set it low
-	ret = gpio_pin_configure(gpio_1dev, GPIO_PIN_15, GPIO_OUTPUT_ACTIVE);
-	if (ret < 0) {
-		LOG_ERR("Failed to configure GPIO pin %d: %d", GPIO_PIN_15, ret);
-		return ret;
+	// Walk the channels of any I2C switches found on the root bus
+	if (IS_ENABLED(CONFIG_I2C_SCANNER_MUX)) {
+		i2c_mux_scan_tree(state);
 	}
 
-	ret = gpio_pin_set(gpio_1dev, GPIO_PIN_15, 1);
-	if (ret < 0) {
-		LOG_ERR("Failed to set GPIO pin %d low: %d", GPIO_PIN_15, ret);
-		return ret;
+	// Notify BLE clients with updated scan results
+	if (IS_ENABLED(CONFIG_I2C_SCANNER_PROGRESS)) {
+		scan_progress_end(early_exit ? SCAN_PROGRESS_EARLY_EXIT : 0);
 	}
+	notify_scan_results();
+	LOG_INF("BLE notification sent: %d devices", scan_result.device_count +
+		scan_result.count_10bit);
 
-	LOG_INF("GPIO 1.15 set LOW");
+	return changed;
+}
 
-	// Configure GPIO pin 2.10 as output and set it low
-	ret = gpio_pin_configure(gpio_2dev, GPIO_PIN_10, GPIO_OUTPUT_INACTIVE);
-	if (ret < 0) {
-		LOG_ERR("Failed to configure GPIO pin %d: %d", GPIO_PIN_10, ret);
-		return ret;
+/**
+ * @brief Drive all devicetree power-rail GPIOs to their active level
+ * @return 0 on success, negative error code otherwise
+ */
+static int power_rails_init(void) {
+	int ret;
+
+	for (size_t i = 0; i < NUM_POWER_GPIOS; i++) {
+		const struct gpio_dt_spec *spec = &power_gpios[i];
+
+		// Check if GPIO device is ready
+		if (!gpio_is_ready_dt(spec)) {
+			LOG_ERR("GPIO device %s not ready!", spec->port->name);
+			return -ENODEV;
+		}
+
+		ret = gpio_pin_configure_dt(spec, GPIO_OUTPUT_ACTIVE);
+		if (ret < 0) {
+			LOG_ERR("Failed to configure GPIO %s.%02d: %d",
+				spec->port->name, spec->pin, ret);
+			return ret;
+		}
+
+		LOG_INF("GPIO %s.%02d set %s", spec->port->name, spec->pin,
+			(spec->dt_flags & GPIO_ACTIVE_LOW) ? "LOW" : "HIGH");
 	}
 
-	ret = gpio_pin_set(gpio_2dev, GPIO_PIN_10, 0);
+	return 0;
+}
+
+int main(void) {
+	int ret;
+
+	ret = power_rails_init();
 	if (ret < 0) {
-		LOG_ERR("Failed to set GPIO pin %d low: %d", GPIO_PIN_10, ret);
 		return ret;
 	}
 
-	LOG_INF("GPIO 2.10 set low");
-
 	// Check if I2C device is ready
 	if (!device_is_ready(i2c_dev)) {
 		LOG_ERR("I2C device not ready!");
@@ -267,6 +648,43 @@ int main(void) {
 
 	LOG_INF("I2C device is ready");
 
+	if (IS_ENABLED(CONFIG_I2C_SCANNER_SMBUS_ALERT)) {
+		ret = smbus_alert_init();
+		if (ret < 0) {
+			return ret;
+		}
+	}
+
+	// Report unknown I2C pin pairs before the bit-banged buses take
+	// over their pins
+	if (IS_ENABLED(CONFIG_I2C_SCANNER_PIN_DISCOVERY)) {
+		i2c_pin_discovery_run();
+	}
+
+	// The bit-banged buses are secondary, the main bus is scanned even
+	// when their pins cannot be configured
+	if (IS_ENABLED(CONFIG_I2C_SCANNER_BITBANG)) {
+		ret = i2c_bitbang_init();
+		if (ret < 0) {
+			LOG_WRN("Bit-banged buses disabled (err %d)", ret);
+		}
+		bitbang_ready = (ret == 0);
+	}
+
+	if (IS_ENABLED(CONFIG_I2C_SCANNER_TARGET)) {
+		ret = host_target_init();
+		if (ret < 0) {
+			return ret;
+		}
+	}
+
+	if (IS_ENABLED(CONFIG_I2C_SCANNER_FIFO_RATE)) {
+		ret = fifo_rate_init();
+		if (ret < 0) {
+			return ret;
+		}
+	}
+
 	// Initialize BLE
 	ret = ble_init();
 	if (ret) {
@@ -280,12 +698,26 @@ int main(void) {
 	// Wait a moment for devices to stabilize
 	k_msleep(100);
 
-	// Perform continuous scanning (scan every 5 seconds)
+	// Perform continuous scanning (every 5 seconds, or adaptively)
 	while (1) {
-		scan_i2c_bus();
+		bool changed = scan_i2c_bus();
+
+#if defined(CONFIG_I2C_SCANNER_BITBANG)
+		if (bitbang_ready) {
+			i2c_bitbang_scan(bitbang_present);
+		}
+#endif
 		LOG_INF("-----------------------------------");
-		LOG_INF("Waiting 5 seconds before next scan...");
-		k_msleep(5000);
+		if (IS_ENABLED(CONFIG_I2C_SCANNER_CADENCE)) {
+			uint32_t period_ms = scan_cadence_next(changed);
+
+			LOG_INF("Bus %s, next scan in %u ms",
+				changed ? "changed" : "stable", period_ms);
+			scan_cadence_wait(period_ms);
+		} else {
+			LOG_INF("Waiting 5 seconds before next scan...");
+			k_msleep(5000);
+		}
 	}
 
 	return 0;
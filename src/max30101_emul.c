@@ -0,0 +1,303 @@
+// MAX30101 behavioural emulator for native_sim
+//
+// Models what the sensor driver and the scanner see on the bus: the part
+// and revision ID registers, soft reset and shutdown, the mode and SpO2
+// configuration and the 32-sample FIFO with its write and read pointers,
+// overflow counter, rollover and almost-full flag. Samples are produced in
+// simulated time at the configured sample rate divided by the averaging
+// factor, so the FIFO fills and overflows as on the real part. A full FIFO
+// has equal read and write pointers just like an empty one and is tracked
+// with a separate flag, so all 32 samples are usable. Transfers take the
+// time they would at the bus clock frequency, which makes FIFO streaming
+// throughput measurable on the host.
+
+#define DT_DRV_COMPAT maxim_max30101
+
+#include <zephyr/kernel.h>
+#include <zephyr/device.h>
+#include <zephyr/drivers/emul.h>
+#include <zephyr/drivers/i2c.h>
+#include <zephyr/drivers/i2c_emul.h>
+#include <zephyr/logging/log.h>
+#include <string.h>
+
+LOG_MODULE_DECLARE(i2c_scanner, LOG_LEVEL_INF);
+
+#define REG_INT_STS1        0x00
+#define REG_INT_STS2        0x01
+#define REG_FIFO_WR         0x04
+#define REG_FIFO_OVF        0x05
+#define REG_FIFO_RD         0x06
+#define REG_FIFO_DATA       0x07
+#define REG_FIFO_CFG        0x08
+#define REG_MODE_CFG        0x09
+#define REG_SPO2_CFG        0x0A
+#define REG_MULTI_LED_1     0x11
+#define REG_MULTI_LED_2     0x12
+#define REG_REV_ID          0xFE
+#define REG_PART_ID         0xFF
+
+#define INT_A_FULL          BIT(7)
+#define INT_PPG_RDY         BIT(6)
+#define INT_PWR_RDY         BIT(0)
+
+#define FIFO_CFG_ROLLOVER   BIT(4)
+#define MODE_CFG_SHDN       BIT(7)
+#define MODE_CFG_RESET      BIT(6)
+#define MODE_HEART_RATE     0x02
+#define MODE_SPO2           0x03
+#define MODE_MULTI_LED      0x07
+
+#define MAX30101_PART_ID    0x15
+#define MAX30101_REV_ID     0x03
+
+#define FIFO_DEPTH          32
+#define MAX_CHANNELS        4
+#define BYTES_PER_CHANNEL   3
+#define ADC_MASK            0x3FFFF
+
+// Samples per second for the SPO2_CFG SR field
+static const uint16_t sample_rates[] = { 50, 100, 200, 400, 800, 1000, 1600, 3200 };
+
+struct max30101_emul_cfg {
+	uint32_t bus_freq;
+};
+
+struct max30101_emul_data {
+	uint8_t regs[256];
+	uint8_t reg_ptr;
+	uint8_t fifo[FIFO_DEPTH][MAX_CHANNELS * BYTES_PER_CHANNEL];
+	uint8_t byte_idx;       // next byte of the sample at the read pointer
+	bool fifo_full;         // read and write pointers equal on a full FIFO
+	uint32_t sample_no;
+	int64_t last_sample_us;
+};
+
+static int num_channels(const struct max30101_emul_data *data)
+{
+	uint8_t mode = data->regs[REG_MODE_CFG] & 0x07;
+	int slots = 0;
+
+	switch (mode) {
+	case MODE_HEART_RATE:
+		return 1;
+	case MODE_SPO2:
+		return 2;
+	case MODE_MULTI_LED:
+		for (int i = 0; i < 2; i++) {
+			uint8_t ctrl = data->regs[REG_MULTI_LED_1 + i];
+
+			slots += ((ctrl & 0x07) != 0) + (((ctrl >> 4) & 0x07) != 0);
+		}
+		return slots;
+	default:
+		return 0;
+	}
+}
+
+static uint32_t sample_period_us(const struct max30101_emul_data *data)
+{
+	uint8_t sr = (data->regs[REG_SPO2_CFG] >> 2) & 0x07;
+	uint8_t smp_ave = MIN(data->regs[REG_FIFO_CFG] >> 5, 5);
+
+	return (USEC_PER_SEC << smp_ave) / sample_rates[sr];
+}
+
+static uint8_t fifo_unread(const struct max30101_emul_data *data)
+{
+	if (data->fifo_full) {
+		return FIFO_DEPTH;
+	}
+	return (data->regs[REG_FIFO_WR] - data->regs[REG_FIFO_RD]) & (FIFO_DEPTH - 1);
+}
+
+static void reset_regs(struct max30101_emul_data *data)
+{
+	memset(data->regs, 0, sizeof(data->regs));
+	data->regs[REG_INT_STS1] = INT_PWR_RDY;
+	data->regs[REG_REV_ID] = MAX30101_REV_ID;
+	data->regs[REG_PART_ID] = MAX30101_PART_ID;
+	data->byte_idx = 0;
+	data->fifo_full = false;
+	data->last_sample_us = k_ticks_to_us_floor64(k_uptime_ticks());
+}
+
+/**
+ * @brief Push one synthetic sample per active channel into the FIFO
+ */
+static void fifo_push(struct max30101_emul_data *data, int channels)
+{
+	uint8_t *slot = data->fifo[data->regs[REG_FIFO_WR]];
+
+	if (data->fifo_full) {
+		data->regs[REG_FIFO_OVF] = MIN(data->regs[REG_FIFO_OVF] + 1, 0x1F);
+		if (!(data->regs[REG_FIFO_CFG] & FIFO_CFG_ROLLOVER)) {
+			return;
+		}
+		// Oldest sample is overwritten
+		data->regs[REG_FIFO_RD] = (data->regs[REG_FIFO_RD] + 1) & (FIFO_DEPTH - 1);
+		data->byte_idx = 0;
+	}
+
+	// Slowly varying level per channel, distinct between channels
+	for (int ch = 0; ch < channels; ch++) {
+		uint32_t val = (0x10000 * (ch + 1) + (data->sample_no * 37) % 0x400) & ADC_MASK;
+
+		slot[ch * BYTES_PER_CHANNEL] = val >> 16;
+		slot[ch * BYTES_PER_CHANNEL + 1] = val >> 8;
+		slot[ch * BYTES_PER_CHANNEL + 2] = val;
+	}
+
+	data->sample_no++;
+	data->regs[REG_FIFO_WR] = (data->regs[REG_FIFO_WR] + 1) & (FIFO_DEPTH - 1);
+	data->fifo_full = data->regs[REG_FIFO_WR] == data->regs[REG_FIFO_RD];
+	data->regs[REG_INT_STS1] |= INT_PPG_RDY;
+	if (fifo_unread(data) >= FIFO_DEPTH - (data->regs[REG_FIFO_CFG] & 0x0F)) {
+		data->regs[REG_INT_STS1] |= INT_A_FULL;
+	}
+}
+
+/**
+ * @brief Produce the samples due since the last update
+ */
+static void fifo_update(struct max30101_emul_data *data)
+{
+	int64_t now_us = k_ticks_to_us_floor64(k_uptime_ticks());
+	int channels = num_channels(data);
+	uint32_t period_us;
+	int64_t due;
+
+	if ((data->regs[REG_MODE_CFG] & MODE_CFG_SHDN) || channels == 0) {
+		data->last_sample_us = now_us;
+		return;
+	}
+
+	period_us = sample_period_us(data);
+	due = (now_us - data->last_sample_us) / period_us;
+	data->last_sample_us += due * period_us;
+
+	// After a long idle period only the last FIFO_DEPTH samples matter,
+	// the overflow counter saturates anyway
+	if (due > FIFO_DEPTH) {
+		data->sample_no += due - FIFO_DEPTH;
+		data->regs[REG_FIFO_OVF] = 0x1F;
+		due = FIFO_DEPTH;
+	}
+	while (due-- > 0) {
+		fifo_push(data, channels);
+	}
+}
+
+static uint8_t read_reg(struct max30101_emul_data *data)
+{
+	uint8_t reg = data->reg_ptr;
+	uint8_t val;
+
+	if (reg == REG_FIFO_DATA) {
+		int sample_len = num_channels(data) * BYTES_PER_CHANNEL;
+
+		// The pointer stays on FIFO_DATA, the read pointer advances
+		// after every complete sample
+		if (fifo_unread(data) == 0 || sample_len == 0) {
+			return 0;
+		}
+		val = data->fifo[data->regs[REG_FIFO_RD]][data->byte_idx++];
+		if (data->byte_idx >= sample_len) {
+			data->byte_idx = 0;
+			data->regs[REG_FIFO_RD] = (data->regs[REG_FIFO_RD] + 1) &
+						  (FIFO_DEPTH - 1);
+			data->fifo_full = false;
+			data->regs[REG_FIFO_OVF] = 0;
+		}
+		return val;
+	}
+
+	val = data->regs[reg];
+	if (reg == REG_INT_STS1 || reg == REG_INT_STS2) {
+		data->regs[reg] = 0;
+	}
+	data->reg_ptr++;
+	return val;
+}
+
+static void write_reg(struct max30101_emul_data *data, uint8_t val)
+{
+	uint8_t reg = data->reg_ptr++;
+
+	switch (reg) {
+	case REG_MODE_CFG:
+		if (val & MODE_CFG_RESET) {
+			// Reset completes immediately, the bit reads back clear
+			reset_regs(data);
+			return;
+		}
+		break;
+	case REG_FIFO_WR:
+	case REG_FIFO_RD:
+		val &= FIFO_DEPTH - 1;
+		data->byte_idx = 0;
+		data->fifo_full = false;
+		break;
+	case REG_INT_STS1:
+	case REG_INT_STS2:
+	case REG_REV_ID:
+	case REG_PART_ID:
+		// Read-only
+		return;
+	default:
+		break;
+	}
+
+	data->regs[reg] = val;
+}
+
+static int max30101_emul_transfer(const struct emul *target, struct i2c_msg *msgs,
+				  int num_msgs, int addr)
+{
+	const struct max30101_emul_cfg *cfg = target->cfg;
+	struct max30101_emul_data *data = target->data;
+	uint32_t bytes = 0;
+
+	fifo_update(data);
+
+	for (int i = 0; i < num_msgs; i++) {
+		struct i2c_msg *msg = &msgs[i];
+
+		if (msg->flags & I2C_MSG_READ) {
+			for (uint32_t j = 0; j < msg->len; j++) {
+				msg->buf[j] = read_reg(data);
+			}
+		} else if (msg->len > 0) {
+			data->reg_ptr = msg->buf[0];
+			for (uint32_t j = 1; j < msg->len; j++) {
+				write_reg(data, msg->buf[j]);
+			}
+		}
+		bytes += msg->len + 1;
+	}
+
+	// Time on the wire: 9 clocks per byte, address bytes included
+	k_busy_wait((uint32_t)((uint64_t)bytes * 9 * USEC_PER_SEC / cfg->bus_freq));
+	return 0;
+}
+
+static const struct i2c_emul_api max30101_emul_api = {
+	.transfer = max30101_emul_transfer,
+};
+
+static int max30101_emul_init(const struct emul *target, const struct device *parent)
+{
+	reset_regs(target->data);
+	return 0;
+}
+
+#define MAX30101_EMUL_DEFINE(n)							\
+	static struct max30101_emul_data max30101_emul_data_##n;		\
+	static const struct max30101_emul_cfg max30101_emul_cfg_##n = {		\
+		.bus_freq = DT_PROP_OR(DT_INST_BUS(n), clock_frequency,		\
+				       I2C_BITRATE_STANDARD),			\
+	};									\
+	EMUL_DT_INST_DEFINE(n, max30101_emul_init, &max30101_emul_data_##n,	\
+			    &max30101_emul_cfg_##n, &max30101_emul_api, NULL);
+
+DT_INST_FOREACH_STATUS_OKAY(MAX30101_EMUL_DEFINE)
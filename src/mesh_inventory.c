@@ -0,0 +1,293 @@
+// Bluetooth Mesh publication of inventory changes
+//
+// A vendor model publishes what changed on the bus to a group address, so
+// any number of scanner nodes report to one sink without a connection each.
+// Change messages name only the addresses that appeared or went away and
+// fit a single unsegmented mesh PDU; the full bitmap is only sent when a
+// change is too large for that and on periodic publication, which doubles
+// as a liveness report at the configured publish period. Relaying and
+// retransmission are tuned with the stack's own options (overlay-mesh.conf).
+
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+#include <zephyr/bluetooth/bluetooth.h>
+#include <zephyr/bluetooth/mesh.h>
+#include <zephyr/drivers/hwinfo.h>
+#include <zephyr/settings/settings.h>
+#include <zephyr/sys/byteorder.h>
+#include <string.h>
+
+#include "mesh_inventory.h"
+
+LOG_MODULE_DECLARE(i2c_scanner, LOG_LEVEL_INF);
+
+// Opcode and payload of a change message within the 11-byte unsegmented
+// access payload
+#define MAX_CHANGES 6
+#define STATUS_LEN  (2 + sizeof(inv_present))
+
+#define NET_IDX 0
+#define APP_IDX 0
+
+static uint32_t inv_present[I2C_NUM_ADDRS / 32];
+static uint8_t inv_count;
+static uint8_t inv_seq;
+static K_MUTEX_DEFINE(inv_lock);
+
+static uint8_t dev_uuid[16];
+
+static void encode_status(struct net_buf_simple *msg)
+{
+	bt_mesh_model_msg_init(msg, MESH_INVENTORY_OP_STATUS);
+	net_buf_simple_add_u8(msg, inv_seq);
+	net_buf_simple_add_u8(msg, inv_count);
+	for (int i = 0; i < ARRAY_SIZE(inv_present); i++) {
+		net_buf_simple_add_le32(msg, inv_present[i]);
+	}
+}
+
+// Periodic publication: refresh the status message
+static int inv_pub_update(const struct bt_mesh_model *mod)
+{
+	k_mutex_lock(&inv_lock, K_FOREVER);
+	encode_status(mod->pub->msg);
+	k_mutex_unlock(&inv_lock);
+	return 0;
+}
+
+BT_MESH_MODEL_PUB_DEFINE(inv_pub, inv_pub_update, 3 + STATUS_LEN);
+
+// Sink side: log the reports of other nodes. The sink also publishes to the
+// group it subscribes to, and the stack loops those messages back.
+static int handle_change(const struct bt_mesh_model *model, struct bt_mesh_msg_ctx *ctx,
+			 struct net_buf_simple *buf)
+{
+	uint8_t seq = net_buf_simple_pull_u8(buf);
+	uint8_t count = net_buf_simple_pull_u8(buf);
+
+	if (bt_mesh_has_addr(ctx->addr)) {
+		return 0;
+	}
+
+	while (buf->len > 0) {
+		uint8_t change = net_buf_simple_pull_u8(buf);
+
+		LOG_INF("Mesh node 0x%04X #%u: 0x%02X %s, %u device(s)", ctx->addr, seq,
+			change & ~MESH_INVENTORY_APPEARED,
+			(change & MESH_INVENTORY_APPEARED) ? "appeared" : "gone", count);
+	}
+	return 0;
+}
+
+static int handle_status(const struct bt_mesh_model *model, struct bt_mesh_msg_ctx *ctx,
+			 struct net_buf_simple *buf)
+{
+	uint8_t seq = net_buf_simple_pull_u8(buf);
+	uint8_t count = net_buf_simple_pull_u8(buf);
+
+	if (bt_mesh_has_addr(ctx->addr)) {
+		return 0;
+	}
+
+	LOG_INF("Mesh node 0x%04X #%u: %u device(s)", ctx->addr, seq, count);
+	return 0;
+}
+
+static const struct bt_mesh_model_op inv_ops[] = {
+	{ MESH_INVENTORY_OP_CHANGE, BT_MESH_LEN_MIN(2), handle_change },
+	{ MESH_INVENTORY_OP_STATUS, BT_MESH_LEN_EXACT(STATUS_LEN), handle_status },
+	BT_MESH_MODEL_OP_END,
+};
+
+static struct bt_mesh_cfg_cli cfg_cli;
+
+static const struct bt_mesh_model root_models[] = {
+	BT_MESH_MODEL_CFG_SRV,
+	BT_MESH_MODEL_CFG_CLI(&cfg_cli),
+};
+
+static const struct bt_mesh_model vnd_models[] = {
+	BT_MESH_MODEL_VND(CONFIG_I2C_SCANNER_MESH_CID, MESH_INVENTORY_MODEL_ID, inv_ops,
+			  &inv_pub, NULL),
+};
+
+static const struct bt_mesh_elem elements[] = {
+	BT_MESH_ELEM(0, root_models, vnd_models),
+};
+
+static const struct bt_mesh_comp comp = {
+	.cid = CONFIG_I2C_SCANNER_MESH_CID,
+	.elem = elements,
+	.elem_count = ARRAY_SIZE(elements),
+};
+
+static void prov_complete(uint16_t net_idx, uint16_t addr)
+{
+	LOG_INF("Mesh provisioned, address 0x%04X", addr);
+}
+
+static const struct bt_mesh_prov prov = {
+	.uuid = dev_uuid,
+	.complete = prov_complete,
+};
+
+#if defined(CONFIG_I2C_SCANNER_MESH_SELF_PROV)
+// Fixed keys for lab and simulation networks only
+static const uint8_t net_key[16] = {
+	0x49, 0x32, 0x43, 0x53, 0x63, 0x61, 0x6e, 0x4e,
+	0x65, 0x74, 0x4b, 0x65, 0x79, 0x00, 0x00, 0x01,
+};
+static const uint8_t app_key[16] = {
+	0x49, 0x32, 0x43, 0x53, 0x63, 0x61, 0x6e, 0x41,
+	0x70, 0x70, 0x4b, 0x65, 0x79, 0x00, 0x00, 0x01,
+};
+
+/**
+ * @brief Unicast address from Kconfig, or derived from the device ID
+ */
+static uint16_t self_address(void)
+{
+	uint16_t addr = CONFIG_I2C_SCANNER_MESH_ADDR;
+
+	if (addr == 0) {
+		addr = sys_get_le16(&dev_uuid[0]) & 0x7FFF;
+	}
+	return addr ? addr : 1;
+}
+
+static int self_provision(void)
+{
+	struct bt_mesh_cfg_cli_mod_pub pub = {
+		.addr = CONFIG_I2C_SCANNER_MESH_GROUP,
+		.app_idx = APP_IDX,
+		.ttl = CONFIG_I2C_SCANNER_MESH_TTL,
+		.period = BT_MESH_PUB_PERIOD_SEC(CONFIG_I2C_SCANNER_MESH_PUB_PERIOD_S),
+	};
+	uint8_t dev_key[16];
+	uint16_t addr = self_address();
+	int err;
+
+	memcpy(dev_key, dev_uuid, sizeof(dev_key));
+
+	err = bt_mesh_provision(net_key, NET_IDX, 0, 0, addr, dev_key);
+	if (err == -EALREADY) {
+		return 0;
+	}
+	if (err) {
+		LOG_ERR("Mesh self-provisioning failed (err %d)", err);
+		return err;
+	}
+
+	err = bt_mesh_cfg_cli_app_key_add(NET_IDX, addr, NET_IDX, APP_IDX, app_key, NULL);
+	if (!err) {
+		err = bt_mesh_cfg_cli_mod_app_bind_vnd(NET_IDX, addr, addr, APP_IDX,
+						       MESH_INVENTORY_MODEL_ID,
+						       CONFIG_I2C_SCANNER_MESH_CID, NULL);
+	}
+	if (!err) {
+		err = bt_mesh_cfg_cli_mod_pub_set_vnd(NET_IDX, addr, addr,
+						      MESH_INVENTORY_MODEL_ID,
+						      CONFIG_I2C_SCANNER_MESH_CID, &pub, NULL);
+	}
+	if (!err && IS_ENABLED(CONFIG_I2C_SCANNER_MESH_SINK)) {
+		err = bt_mesh_cfg_cli_mod_sub_add_vnd(NET_IDX, addr, addr,
+						      CONFIG_I2C_SCANNER_MESH_GROUP,
+						      MESH_INVENTORY_MODEL_ID,
+						      CONFIG_I2C_SCANNER_MESH_CID, NULL);
+	}
+	if (err) {
+		LOG_ERR("Mesh self-configuration failed (err %d)", err);
+		return err;
+	}
+
+	LOG_INF("Mesh self-provisioned as 0x%04X, publishing to 0x%04X", addr,
+		CONFIG_I2C_SCANNER_MESH_GROUP);
+	return 0;
+}
+#endif /* CONFIG_I2C_SCANNER_MESH_SELF_PROV */
+
+int mesh_inventory_init(void)
+{
+	int err;
+
+	hwinfo_get_device_id(dev_uuid, sizeof(dev_uuid));
+
+	err = bt_mesh_init(&prov, &comp);
+	if (err) {
+		LOG_ERR("Mesh init failed (err %d)", err);
+		return err;
+	}
+
+	// Restore the provisioning data and configuration stored by an earlier
+	// run, before deciding whether the node still needs provisioning
+	if (IS_ENABLED(CONFIG_BT_SETTINGS)) {
+		err = settings_load();
+		if (err) {
+			LOG_ERR("Settings load failed (err %d)", err);
+			return err;
+		}
+		if (bt_mesh_is_provisioned()) {
+			LOG_INF("Mesh configuration restored");
+		}
+	}
+
+#if defined(CONFIG_I2C_SCANNER_MESH_SELF_PROV)
+	return self_provision();
+#else
+	if (!bt_mesh_is_provisioned()) {
+		bt_mesh_prov_enable(BT_MESH_PROV_ADV | BT_MESH_PROV_GATT);
+		LOG_INF("Mesh waiting for provisioning");
+	}
+	return 0;
+#endif
+}
+
+void mesh_inventory_update(const uint32_t present[I2C_NUM_ADDRS / 32],
+			   const uint32_t previous[I2C_NUM_ADDRS / 32])
+{
+	struct net_buf_simple *msg = inv_pub.msg;
+	uint8_t changes[MAX_CHANGES];
+	int num_changes = 0;
+	int count = 0;
+	int err;
+
+	for (int w = 0; w < ARRAY_SIZE(inv_present); w++) {
+		uint32_t diff = present[w] ^ previous[w];
+
+		count += __builtin_popcount(present[w]);
+		while (diff) {
+			int bit = find_lsb_set(diff) - 1;
+
+			if (num_changes < MAX_CHANGES) {
+				changes[num_changes] = w * 32 + bit;
+				if (present[w] & BIT(bit)) {
+					changes[num_changes] |= MESH_INVENTORY_APPEARED;
+				}
+			}
+			num_changes++;
+			diff &= ~BIT(bit);
+		}
+	}
+
+	k_mutex_lock(&inv_lock, K_FOREVER);
+	memcpy(inv_present, present, sizeof(inv_present));
+	inv_count = count;
+	inv_seq++;
+
+	if (num_changes <= MAX_CHANGES) {
+		bt_mesh_model_msg_init(msg, MESH_INVENTORY_OP_CHANGE);
+		net_buf_simple_add_u8(msg, inv_seq);
+		net_buf_simple_add_u8(msg, inv_count);
+		net_buf_simple_add_mem(msg, changes, num_changes);
+	} else {
+		encode_status(msg);
+	}
+
+	err = bt_mesh_model_publish(&vnd_models[0]);
+	k_mutex_unlock(&inv_lock);
+
+	// -EADDRNOTAVAIL: no publication configured yet
+	if (err && err != -EADDRNOTAVAIL) {
+		LOG_ERR("Mesh publish failed (err %d)", err);
+	}
+}
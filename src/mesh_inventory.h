@@ -0,0 +1,46 @@
+// Bluetooth Mesh publication of inventory changes
+
+#ifndef MESH_INVENTORY_H_
+#define MESH_INVENTORY_H_
+
+#include <stdint.h>
+
+#include "scanner.h"
+
+// Vendor model and its messages. A change message carries a sequence
+// number, the device count and one byte per changed address, with bit 7
+// set if the device appeared and clear if it went away. A status message
+// carries the sequence number, the device count and the full 128-bit
+// address bitmap (little endian words), and is also sent on every periodic
+// publication.
+#define MESH_INVENTORY_MODEL_ID     0x0001
+#define MESH_INVENTORY_OP_CHANGE    BT_MESH_MODEL_OP_3(0x01, CONFIG_I2C_SCANNER_MESH_CID)
+#define MESH_INVENTORY_OP_STATUS    BT_MESH_MODEL_OP_3(0x02, CONFIG_I2C_SCANNER_MESH_CID)
+#define MESH_INVENTORY_APPEARED     BIT(7)
+
+/**
+ * @brief Register the inventory model with the mesh stack
+ *
+ * Called after bt_enable() and before advertising starts. With
+ * CONFIG_BT_SETTINGS the stored settings are loaded first, so a node that was
+ * provisioned before keeps its address and keys. Otherwise, with
+ * CONFIG_I2C_SCANNER_MESH_SELF_PROV the node provisions and configures
+ * itself, or it waits for a provisioner.
+ *
+ * @return 0 on success, negative error code otherwise
+ */
+int mesh_inventory_init(void);
+
+/**
+ * @brief Publish the difference between two sweeps
+ *
+ * Changes that fit one unsegmented message are sent as a change message,
+ * larger ones as a status message.
+ *
+ * @param present Address bitmap of the latest sweep
+ * @param previous Address bitmap of the sweep before
+ */
+void mesh_inventory_update(const uint32_t present[I2C_NUM_ADDRS / 32],
+			   const uint32_t previous[I2C_NUM_ADDRS / 32]);
+
+#endif /* MESH_INVENTORY_H_ */
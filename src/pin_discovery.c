@@ -0,0 +1,135 @@
+// Automatic SCL/SDA pin-pair discovery
+//
+// Candidate pins come from the discovery-gpios property of the zephyr,user
+// node and must share one GPIO port. An idle I2C line is held high by an
+// external pull-up, so every candidate is first sampled with the internal
+// pull-down enabled; pins that read low cannot be I2C lines and are dropped
+// before any pair is tried. Each remaining ordered pair then gets a
+// bit-banged mini-sweep that stops at the first acknowledging address, and
+// pins of a confirmed pair are not tried again.
+
+#include <zephyr/kernel.h>
+#include <zephyr/drivers/gpio.h>
+#include <zephyr/logging/log.h>
+
+#include "scanner.h"
+#include "i2c_bitbang.h"
+#include "pin_discovery.h"
+
+LOG_MODULE_DECLARE(i2c_scanner, LOG_LEVEL_INF);
+
+#define ZEPHYR_USER_NODE DT_PATH(zephyr_user)
+
+BUILD_ASSERT(DT_NODE_HAS_PROP(ZEPHYR_USER_NODE, discovery_gpios),
+	     "CONFIG_I2C_SCANNER_PIN_DISCOVERY needs discovery-gpios in zephyr,user");
+
+#define DISC_GPIO_SPEC(node, prop, idx) GPIO_DT_SPEC_GET_BY_IDX(node, prop, idx),
+
+static const struct gpio_dt_spec candidates[] = {
+	DT_FOREACH_PROP_ELEM(ZEPHYR_USER_NODE, discovery_gpios, DISC_GPIO_SPEC)
+};
+
+// Settling time before sampling a line against the internal pull-down
+#define PULLUP_SETTLE_US 20
+
+/**
+ * @brief Check whether a pin idles high against the internal pull-down
+ */
+static bool has_external_pullup(const struct gpio_dt_spec *pin)
+{
+	gpio_port_value_t val = 0;
+
+	if (gpio_pin_configure(pin->port, pin->pin, GPIO_INPUT | GPIO_PULL_DOWN) < 0) {
+		return false;
+	}
+
+	k_busy_wait(PULLUP_SETTLE_US);
+	gpio_port_get_raw(pin->port, &val);
+	gpio_pin_configure(pin->port, pin->pin, GPIO_INPUT);
+
+	return (val & BIT(pin->pin)) != 0;
+}
+
+/**
+ * @brief Sweep a candidate pair until the first device acknowledges
+ * @return First acknowledging address, or 0 if nothing answered
+ */
+static uint8_t mini_sweep(const struct gpio_dt_spec *scl, const struct gpio_dt_spec *sda)
+{
+	struct i2c_bitbang_lines lines = { .port = scl->port };
+	uint8_t found = 0;
+
+	if (i2c_bitbang_configure_pair(&lines, scl->pin, 0, sda->pin, 0) < 0) {
+		return 0;
+	}
+
+	for (uint8_t addr = I2C_SCAN_START; addr <= I2C_SCAN_END; addr++) {
+		if (i2c_bitbang_probe(&lines, addr) != 0) {
+			found = addr;
+			break;
+		}
+		// A line held low means this is not a working pair
+		if (lines.stuck_scl != 0) {
+			break;
+		}
+	}
+
+	gpio_pin_configure(scl->port, scl->pin, GPIO_INPUT);
+	gpio_pin_configure(sda->port, sda->pin, GPIO_INPUT);
+	return found;
+}
+
+int i2c_pin_discovery_run(void)
+{
+	const struct device *port = candidates[0].port;
+	uint32_t usable = 0;
+	int pairs = 0;
+	int tried = 0;
+
+	if (!device_is_ready(port)) {
+		LOG_ERR("GPIO device %s not ready!", port->name);
+		return -ENODEV;
+	}
+
+	for (size_t i = 0; i < ARRAY_SIZE(candidates); i++) {
+		if (candidates[i].port != port) {
+			LOG_ERR("Discovery pin %d is not on %s", (int)i, port->name);
+			return -EINVAL;
+		}
+		if (has_external_pullup(&candidates[i])) {
+			usable |= BIT(i);
+		}
+	}
+
+	LOG_INF("Pin discovery: %d of %d candidate pins pulled up",
+		popcount(usable), (int)ARRAY_SIZE(candidates));
+
+	for (size_t i = 0; i < ARRAY_SIZE(candidates); i++) {
+		for (size_t j = 0; j < ARRAY_SIZE(candidates); j++) {
+			const struct gpio_dt_spec *scl = &candidates[i];
+			const struct gpio_dt_spec *sda = &candidates[j];
+			uint8_t addr;
+
+			if (i == j || !(usable & BIT(i)) || !(usable & BIT(j))) {
+				continue;
+			}
+
+			tried++;
+			addr = mini_sweep(scl, sda);
+			if (addr == 0) {
+				continue;
+			}
+
+			LOG_INF("I2C pair found: SCL %s.%02d SDA %s.%02d (first device 0x%02X)",
+				port->name, scl->pin, port->name, sda->pin, addr);
+			pairs++;
+
+			// Both pins are taken, skip every other pair using them
+			usable &= ~(BIT(i) | BIT(j));
+			break;
+		}
+	}
+
+	LOG_INF("Pin discovery complete: %d pair(s) found, %d pair(s) tried", pairs, tried);
+	return pairs;
+}
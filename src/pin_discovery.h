@@ -0,0 +1,16 @@
+// Automatic SCL/SDA pin-pair discovery
+
+#ifndef PIN_DISCOVERY_H_
+#define PIN_DISCOVERY_H_
+
+/**
+ * @brief Find which candidate GPIO pin pairs carry an I2C bus with devices
+ *
+ * Pins without an external pull-up are skipped, every other ordered pair
+ * gets a bit-banged sweep that stops at the first acknowledging address.
+ *
+ * @return Number of pairs hosting devices, or negative error code
+ */
+int i2c_pin_discovery_run(void);
+
+#endif /* PIN_DISCOVERY_H_ */
@@ -0,0 +1,455 @@
+// SMBus/PMBus telemetry for discovered power devices
+//
+// After a sweep, responding devices are identified by a PEC-checked block
+// read of MFR_ID/MFR_MODEL (PMBus regulators) or ManufacturerName/DeviceName
+// (SBS smart batteries). Identified devices are then polled periodically:
+// voltage, current and temperature are fetched in a single batched
+// i2c_transfer() per device and published as a compact report.
+//
+// Responders that fail identification are remembered until they leave the
+// bus, so ordinary devices do not see the identification reads every sweep.
+// With bus sharing, each block read and each batched word read takes the bus
+// as one bounded chunk.
+
+#include <zephyr/kernel.h>
+#include <zephyr/drivers/i2c.h>
+#include <zephyr/logging/log.h>
+#include <zephyr/sys/crc.h>
+#include <zephyr/sys/byteorder.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(CONFIG_BT)
+#include <zephyr/bluetooth/bluetooth.h>
+#include <zephyr/bluetooth/uuid.h>
+#include <zephyr/bluetooth/gatt.h>
+#endif
+
+#include "scanner.h"
+#include "bus_share.h"
+#include "pmbus_telemetry.h"
+
+LOG_MODULE_DECLARE(i2c_scanner, LOG_LEVEL_INF);
+
+// PMBus commands (PMBus 1.3 part II)
+#define PMBUS_VOUT_MODE          0x20
+#define PMBUS_READ_VOUT          0x8B
+#define PMBUS_READ_IOUT          0x8C
+#define PMBUS_READ_TEMPERATURE_1 0x8D
+#define PMBUS_MFR_ID             0x99
+#define PMBUS_MFR_MODEL          0x9A
+
+// Smart Battery Data commands (SBS 1.1)
+#define SBS_TEMPERATURE          0x08
+#define SBS_VOLTAGE              0x09
+#define SBS_CURRENT              0x0A
+#define SBS_MANUFACTURER_NAME    0x20
+#define SBS_DEVICE_NAME          0x21
+
+// Smart batteries always answer on this address
+#define SBS_BATTERY_ADDR         0x0B
+
+// Longest identification string read, longer ones are rejected
+#define ID_STR_MAX               16
+
+// Number of word reads batched into one transfer
+#define TELEMETRY_READS          3
+
+enum power_dev_type {
+	POWER_DEV_PMBUS,
+	POWER_DEV_SBS,
+};
+
+struct power_dev {
+	uint8_t addr;
+	uint8_t type;
+	int8_t vout_exp;          // PMBus VOUT_MODE exponent
+	char mfr[ID_STR_MAX + 1];
+	char model[ID_STR_MAX + 1];
+};
+
+static struct power_dev power_devs[CONFIG_I2C_SCANNER_PMBUS_MAX_DEVICES];
+static int num_power_devs;
+static struct pmbus_report reports[CONFIG_I2C_SCANNER_PMBUS_MAX_DEVICES];
+static uint32_t not_power_dev[I2C_NUM_ADDRS / 32];
+static K_MUTEX_DEFINE(power_devs_lock);
+
+static void telemetry_work_handler(struct k_work *work);
+static K_WORK_DELAYABLE_DEFINE(telemetry_work, telemetry_work_handler);
+
+#if defined(CONFIG_BT)
+#define BT_UUID_I2C_TELEMETRY_SERVICE_VAL \
+	BT_UUID_128_ENCODE(0x12345678, 0x1234, 0x5678, 0x1234, 0x56789abcdef2)
+#define BT_UUID_I2C_TELEMETRY_REPORT_VAL \
+	BT_UUID_128_ENCODE(0x12345678, 0x1234, 0x5678, 0x1234, 0x56789abcdef3)
+
+#define BT_UUID_I2C_TELEMETRY_SERVICE BT_UUID_DECLARE_128(BT_UUID_I2C_TELEMETRY_SERVICE_VAL)
+#define BT_UUID_I2C_TELEMETRY_REPORT  BT_UUID_DECLARE_128(BT_UUID_I2C_TELEMETRY_REPORT_VAL)
+
+// GATT read callback for the latest telemetry reports
+static ssize_t read_telemetry(struct bt_conn *conn,
+			      const struct bt_gatt_attr *attr,
+			      void *buf, uint16_t len, uint16_t offset)
+{
+	return bt_gatt_attr_read(conn, attr, buf, len, offset, reports,
+				 num_power_devs * sizeof(reports[0]));
+}
+
+BT_GATT_SERVICE_DEFINE(i2c_telemetry_svc,
+	BT_GATT_PRIMARY_SERVICE(BT_UUID_I2C_TELEMETRY_SERVICE),
+	BT_GATT_CHARACTERISTIC(BT_UUID_I2C_TELEMETRY_REPORT,
+			       BT_GATT_CHRC_READ | BT_GATT_CHRC_NOTIFY,
+			       BT_GATT_PERM_READ,
+			       read_telemetry, NULL, reports),
+	BT_GATT_CCC(NULL, BT_GATT_PERM_READ | BT_GATT_PERM_WRITE),
+);
+#endif /* CONFIG_BT */
+
+/**
+ * @brief Compute the SMBus PEC of a read transaction
+ * @param addr Target address
+ * @param cmd Command code
+ * @param data Bytes returned by the target, excluding the PEC byte
+ * @param len Number of bytes in @p data
+ * @return CRC-8 (x^8 + x^2 + x + 1) over the whole transaction
+ */
+static uint8_t smbus_pec(uint8_t addr, uint8_t cmd, const uint8_t *data, size_t len)
+{
+	uint8_t hdr[3] = { addr << 1, cmd, (addr << 1) | 1 };
+	uint8_t pec;
+
+	pec = crc8_ccitt(0, hdr, sizeof(hdr));
+	return crc8_ccitt(pec, data, len);
+}
+
+/**
+ * @brief SMBus block read with PEC check
+ *
+ * The byte count is read on its own first, so the block read itself clocks
+ * exactly count + data + PEC bytes and never runs past the end of the block.
+ *
+ * @param addr Target address
+ * @param cmd Command code
+ * @param str Receives the NUL terminated block contents
+ * @return 0 on success, -EIO on bus error, -EBADMSG on length or PEC error
+ */
+static int smbus_block_read_str(uint8_t addr, uint8_t cmd, char str[ID_STR_MAX + 1])
+{
+	uint8_t buf[1 + ID_STR_MAX + 1];
+	uint8_t count;
+	int ret;
+
+	if (IS_ENABLED(CONFIG_I2C_SCANNER_SHARE)) {
+		bus_share_probe_begin();
+	}
+
+	ret = i2c_write_read(i2c_dev, addr, &cmd, 1, &count, 1);
+	if (ret == 0 && (count == 0 || count > ID_STR_MAX)) {
+		ret = -EBADMSG;
+	}
+	if (ret == 0) {
+		ret = i2c_write_read(i2c_dev, addr, &cmd, 1, buf, 1 + count + 1);
+	}
+
+	if (IS_ENABLED(CONFIG_I2C_SCANNER_SHARE)) {
+		bus_share_probe_end();
+	}
+
+	if (ret < 0) {
+		return ret;
+	}
+
+	if (buf[0] != count ||
+	    smbus_pec(addr, cmd, buf, 1 + count) != buf[1 + count]) {
+		return -EBADMSG;
+	}
+
+	memcpy(str, &buf[1], count);
+	str[count] = '\0';
+	return 0;
+}
+
+/**
+ * @brief Read several SMBus words in one batched transfer, checking PEC
+ * @param addr Target address
+ * @param cmds Command codes to read
+ * @param words Receives the decoded words
+ * @return 0 on success, negative error code otherwise
+ */
+static int smbus_read_words(uint8_t addr, const uint8_t cmds[TELEMETRY_READS],
+			    uint16_t words[TELEMETRY_READS])
+{
+	uint8_t data[TELEMETRY_READS][3];
+	struct i2c_msg msgs[2 * TELEMETRY_READS];
+	int ret;
+
+	for (int i = 0; i < TELEMETRY_READS; i++) {
+		msgs[2 * i].buf = (uint8_t *)&cmds[i];
+		msgs[2 * i].len = 1;
+		msgs[2 * i].flags = I2C_MSG_WRITE | (i > 0 ? I2C_MSG_RESTART : 0);
+
+		msgs[2 * i + 1].buf = data[i];
+		msgs[2 * i + 1].len = sizeof(data[i]);
+		msgs[2 * i + 1].flags = I2C_MSG_READ | I2C_MSG_RESTART;
+	}
+	msgs[ARRAY_SIZE(msgs) - 1].flags |= I2C_MSG_STOP;
+
+	if (IS_ENABLED(CONFIG_I2C_SCANNER_SHARE)) {
+		bus_share_probe_begin();
+	}
+
+	ret = i2c_transfer(i2c_dev, msgs, ARRAY_SIZE(msgs), addr);
+
+	if (IS_ENABLED(CONFIG_I2C_SCANNER_SHARE)) {
+		bus_share_probe_end();
+	}
+
+	if (ret < 0) {
+		return ret;
+	}
+
+	for (int i = 0; i < TELEMETRY_READS; i++) {
+		if (smbus_pec(addr, cmds[i], data[i], 2) != data[i][2]) {
+			return -EBADMSG;
+		}
+		words[i] = sys_get_le16(data[i]);
+	}
+
+	return 0;
+}
+
+/**
+ * @brief Scale a PMBus mantissa by 2^exponent, in thousandths of its unit
+ *
+ * Positive exponents overflow 32 bits for large mantissas, so the product is
+ * taken in 64 bits and clamped.
+ */
+static int32_t scale_milli(int32_t mantissa, int32_t exponent)
+{
+	int64_t milli = (int64_t)mantissa * 1000;
+
+	if (exponent >= 0) {
+		milli *= (int64_t)1 << exponent;
+	} else {
+		milli /= (int64_t)1 << -exponent;
+	}
+	return CLAMP(milli, INT32_MIN, INT32_MAX);
+}
+
+/**
+ * @brief Convert a PMBus LINEAR11 value to thousandths of its unit
+ */
+static int32_t linear11_to_milli(uint16_t raw)
+{
+	return scale_milli(sign_extend(raw & 0x7FF, 10), sign_extend(raw >> 11, 4));
+}
+
+/**
+ * @brief Convert a PMBus LINEAR16 output voltage to millivolts
+ */
+static int32_t linear16_to_milli(uint16_t raw, int8_t exponent)
+{
+	return scale_milli(raw, exponent);
+}
+
+/**
+ * @brief Identify a device as a PMBus regulator or smart battery
+ * @param addr Address of a device that answered the sweep
+ * @param dev Filled in on success
+ * @return 0 if the device was identified, negative error code otherwise
+ */
+static int identify_power_device(uint8_t addr, struct power_dev *dev)
+{
+	uint8_t cmd = PMBUS_VOUT_MODE;
+	uint8_t mode;
+	int ret;
+
+	dev->addr = addr;
+
+	if (addr == SBS_BATTERY_ADDR &&
+	    smbus_block_read_str(addr, SBS_MANUFACTURER_NAME, dev->mfr) == 0) {
+		dev->type = POWER_DEV_SBS;
+		dev->vout_exp = 0;
+		if (smbus_block_read_str(addr, SBS_DEVICE_NAME, dev->model) < 0) {
+			dev->model[0] = '\0';
+		}
+		return 0;
+	}
+
+	if (smbus_block_read_str(addr, PMBUS_MFR_ID, dev->mfr) < 0) {
+		return -ENODEV;
+	}
+
+	dev->type = POWER_DEV_PMBUS;
+	if (smbus_block_read_str(addr, PMBUS_MFR_MODEL, dev->model) < 0) {
+		dev->model[0] = '\0';
+	}
+
+	if (IS_ENABLED(CONFIG_I2C_SCANNER_SHARE)) {
+		bus_share_probe_begin();
+	}
+
+	ret = i2c_write_read(i2c_dev, addr, &cmd, 1, &mode, 1);
+
+	if (IS_ENABLED(CONFIG_I2C_SCANNER_SHARE)) {
+		bus_share_probe_end();
+	}
+
+	// Only linear VOUT mode is decoded, the exponent is the low 5 bits
+	if (ret == 0 && (mode >> 5) == 0) {
+		dev->vout_exp = sign_extend(mode & 0x1F, 4);
+	} else {
+		dev->vout_exp = 0;
+	}
+
+	return 0;
+}
+
+/**
+ * @brief Read voltage, current and temperature of one device
+ * @param dev Device to read
+ * @param report Filled in on success
+ * @return 0 on success, negative error code otherwise
+ */
+static int read_power_device(const struct power_dev *dev, struct pmbus_report *report)
+{
+	static const uint8_t pmbus_cmds[TELEMETRY_READS] = {
+		PMBUS_READ_VOUT, PMBUS_READ_IOUT, PMBUS_READ_TEMPERATURE_1,
+	};
+	static const uint8_t sbs_cmds[TELEMETRY_READS] = {
+		SBS_VOLTAGE, SBS_CURRENT, SBS_TEMPERATURE,
+	};
+	uint16_t words[TELEMETRY_READS];
+	int ret;
+
+	report->addr = dev->addr;
+	report->type = dev->type;
+
+	if (dev->type == POWER_DEV_SBS) {
+		ret = smbus_read_words(dev->addr, sbs_cmds, words);
+		if (ret < 0) {
+			return ret;
+		}
+		// SBS reports mV, mA and 0.1 K
+		report->voltage_mv = words[0];
+		report->current_ma = (int16_t)words[1];
+		report->temp_dc = (int16_t)words[2] - 2731;
+		return 0;
+	}
+
+	ret = smbus_read_words(dev->addr, pmbus_cmds, words);
+	if (ret < 0) {
+		return ret;
+	}
+
+	report->voltage_mv = CLAMP(linear16_to_milli(words[0], dev->vout_exp), INT16_MIN,
+				   INT16_MAX);
+	report->current_ma = CLAMP(linear11_to_milli(words[1]), INT16_MIN, INT16_MAX);
+	report->temp_dc = CLAMP(linear11_to_milli(words[2]) / 100, INT16_MIN, INT16_MAX);
+	return 0;
+}
+
+static void telemetry_work_handler(struct k_work *work)
+{
+	k_mutex_lock(&power_devs_lock, K_FOREVER);
+
+	for (int i = 0; i < num_power_devs; i++) {
+		struct pmbus_report *report = &reports[i];
+
+		if (read_power_device(&power_devs[i], report) < 0) {
+			LOG_WRN("Telemetry read from 0x%02X failed", power_devs[i].addr);
+			continue;
+		}
+
+		LOG_INF("0x%02X: %d mV %d mA %d.%d C", report->addr,
+			report->voltage_mv, report->current_ma,
+			report->temp_dc / 10, abs(report->temp_dc % 10));
+	}
+
+#if defined(CONFIG_BT)
+	if (num_power_devs > 0) {
+		int err = bt_gatt_notify(NULL, &i2c_telemetry_svc.attrs[1], reports,
+					 num_power_devs * sizeof(reports[0]));
+		if (err && err != -ENOTCONN) {
+			LOG_ERR("BLE telemetry notify failed (err %d)", err);
+		}
+	}
+#endif
+
+	k_mutex_unlock(&power_devs_lock);
+
+	k_work_schedule(&telemetry_work, K_MSEC(CONFIG_I2C_SCANNER_PMBUS_PERIOD_MS));
+}
+
+/**
+ * @brief Look up a device identified by a previous discovery
+ * @return Index into power_devs[], or -1 if unknown
+ */
+static int find_power_device(const struct power_dev *devs, int count, uint8_t addr)
+{
+	for (int i = 0; i < count; i++) {
+		if (devs[i].addr == addr) {
+			return i;
+		}
+	}
+	return -1;
+}
+
+int pmbus_telemetry_discover(const uint8_t state[I2C_NUM_ADDRS])
+{
+	static struct power_dev prev[CONFIG_I2C_SCANNER_PMBUS_MAX_DEVICES];
+	int num_prev;
+
+	k_mutex_lock(&power_devs_lock, K_FOREVER);
+
+	// Devices that are still present keep their identification, only new
+	// addresses cost identification reads
+	memcpy(prev, power_devs, sizeof(prev));
+	num_prev = num_power_devs;
+	num_power_devs = 0;
+
+	for (uint8_t addr = I2C_SCAN_START; addr <= I2C_SCAN_END; addr++) {
+		struct power_dev *dev;
+		int known;
+
+		if (state[addr] != PROBE_PRESENT) {
+			// Whatever comes back at this address is identified anew
+			not_power_dev[addr / 32] &= ~BIT(addr % 32);
+			continue;
+		}
+
+		if (not_power_dev[addr / 32] & BIT(addr % 32)) {
+			continue;
+		}
+
+		if (num_power_devs >= CONFIG_I2C_SCANNER_PMBUS_MAX_DEVICES) {
+			LOG_WRN("Power device table full, ignoring 0x%02X and up", addr);
+			break;
+		}
+
+		dev = &power_devs[num_power_devs];
+		known = find_power_device(prev, num_prev, addr);
+		if (known >= 0) {
+			*dev = prev[known];
+			num_power_devs++;
+		} else if (identify_power_device(addr, dev) == 0) {
+			LOG_INF("0x%02X: %s %s %s", addr,
+				dev->type == POWER_DEV_SBS ? "Smart battery" : "PMBus",
+				dev->mfr, dev->model);
+			num_power_devs++;
+		} else {
+			not_power_dev[addr / 32] |= BIT(addr % 32);
+		}
+	}
+
+	k_mutex_unlock(&power_devs_lock);
+
+	// Collect the first report right away, then periodically
+	if (num_power_devs > 0) {
+		k_work_schedule(&telemetry_work, K_NO_WAIT);
+	} else {
+		k_work_cancel_delayable(&telemetry_work);
+	}
+
+	return num_power_devs;
+}
@@ -0,0 +1,32 @@
+// SMBus/PMBus telemetry for discovered power devices
+
+#ifndef PMBUS_TELEMETRY_H_
+#define PMBUS_TELEMETRY_H_
+
+#include <stdint.h>
+#include <zephyr/toolchain.h>
+
+#include "scanner.h"
+
+// Compact telemetry report, one per power device, as sent over BLE
+struct pmbus_report {
+	uint8_t addr;
+	uint8_t type;           // 0 = PMBus regulator, 1 = SBS smart battery
+	int16_t voltage_mv;
+	int16_t current_ma;
+	int16_t temp_dc;        // tenths of a degree Celsius
+} __packed;
+
+/**
+ * @brief Identify PMBus regulators and smart batteries among found devices
+ *
+ * Devices are recognised by a PEC-checked MFR_ID (PMBus) or ManufacturerName
+ * (SBS) block read. Telemetry collection starts right away and repeats every
+ * CONFIG_I2C_SCANNER_PMBUS_PERIOD_MS while power devices are present.
+ *
+ * @param state Per-address probe state of the completed sweep
+ * @return Number of power devices found
+ */
+int pmbus_telemetry_discover(const uint8_t state[I2C_NUM_ADDRS]);
+
+#endif /* PMBUS_TELEMETRY_H_ */
@@ -0,0 +1,221 @@
+// Per-address presence statistics
+//
+// Only transitions touch the table: the present bitmap of a sweep is XORed
+// with the previous one and just the changed addresses are updated. Values
+// that grow while nothing changes (present time, last seen, consecutive
+// failed sweeps) are derived from timestamps when they are read.
+
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+#include <zephyr/sys/byteorder.h>
+#include <string.h>
+
+#if defined(CONFIG_BT)
+#include <zephyr/bluetooth/bluetooth.h>
+#include <zephyr/bluetooth/uuid.h>
+#include <zephyr/bluetooth/gatt.h>
+#endif
+
+#if defined(CONFIG_SHELL)
+#include <zephyr/shell/shell.h>
+#endif
+
+#include "scanner.h"
+#include "presence_stats.h"
+
+LOG_MODULE_DECLARE(i2c_scanner, LOG_LEVEL_INF);
+
+#define NUM_WORDS (I2C_NUM_ADDRS / 32)
+
+struct presence_slot {
+	uint32_t first_seen;    // uptime in seconds
+	uint32_t last_change;   // uptime in seconds of the last transition
+	uint32_t last_seen;     // uptime in seconds of the last present sweep
+	uint32_t present_time;  // seconds present, up to last_change
+	uint32_t gone_sweep;    // number of the first sweep missed after leaving
+	uint16_t transitions;
+	uint8_t addr;
+	bool present;
+};
+
+static struct presence_slot slots[CONFIG_I2C_SCANNER_STATS_MAX];
+static int num_slots;
+// Slot index + 1 per address, 0 if the address was never seen
+static uint8_t slot_of[I2C_NUM_ADDRS];
+static uint32_t prev_present[NUM_WORDS];
+static uint32_t sweeps;
+// Uptime in seconds of the latest sweep
+static uint32_t last_sweep_s;
+static K_MUTEX_DEFINE(stats_lock);
+
+static uint32_t uptime_s(void)
+{
+	return k_uptime_get() / MSEC_PER_SEC;
+}
+
+/**
+ * @brief Record a transition of @p addr
+ * @param prev Uptime of the previous sweep, the last one a departed address
+ *             was present in
+ */
+static void slot_update(uint8_t addr, bool present, uint32_t now, uint32_t prev)
+{
+	struct presence_slot *slot;
+
+	if (slot_of[addr] == 0) {
+		if (!present || num_slots >= CONFIG_I2C_SCANNER_STATS_MAX) {
+			return;
+		}
+		slot = &slots[num_slots++];
+		memset(slot, 0, sizeof(*slot));
+		slot->addr = addr;
+		slot->first_seen = now;
+		slot_of[addr] = num_slots;
+	} else {
+		slot = &slots[slot_of[addr] - 1];
+		slot->transitions++;
+	}
+
+	if (present) {
+		slot->last_change = now;
+	} else {
+		slot->present_time += now - slot->last_change;
+		slot->last_change = now;
+		slot->last_seen = prev;
+		slot->gone_sweep = sweeps;
+	}
+	slot->present = present;
+}
+
+void presence_stats_update(const uint8_t state[I2C_NUM_ADDRS])
+{
+	uint32_t present[NUM_WORDS] = { 0 };
+	uint32_t now = uptime_s();
+	uint32_t prev;
+
+	for (uint8_t addr = I2C_SCAN_START; addr <= I2C_SCAN_END; addr++) {
+		if (state[addr] == PROBE_PRESENT) {
+			present[addr / 32] |= BIT(addr % 32);
+		}
+	}
+
+	k_mutex_lock(&stats_lock, K_FOREVER);
+	sweeps++;
+	prev = last_sweep_s;
+	last_sweep_s = now;
+
+	for (int w = 0; w < NUM_WORDS; w++) {
+		uint32_t changed = present[w] ^ prev_present[w];
+
+		while (changed) {
+			int bit = find_lsb_set(changed) - 1;
+
+			slot_update(w * 32 + bit, present[w] & BIT(bit), now, prev);
+			changed &= ~BIT(bit);
+		}
+		prev_present[w] = present[w];
+	}
+
+	k_mutex_unlock(&stats_lock);
+}
+
+/**
+ * @brief Fill a report entry from a slot, deriving the time based values
+ */
+static void slot_report(const struct presence_slot *slot, uint32_t now,
+			struct presence_report *rep)
+{
+	rep->addr = slot->addr;
+	rep->present = slot->present;
+	rep->transitions = sys_cpu_to_le16(slot->transitions);
+	rep->first_seen_s = sys_cpu_to_le32(slot->first_seen);
+	if (slot->present) {
+		rep->last_seen_s = sys_cpu_to_le32(last_sweep_s);
+		rep->present_s = sys_cpu_to_le32(slot->present_time + now - slot->last_change);
+		rep->consecutive_failures = 0;
+	} else {
+		rep->last_seen_s = sys_cpu_to_le32(slot->last_seen);
+		rep->present_s = sys_cpu_to_le32(slot->present_time);
+		// The departure sweep itself already counts as a miss
+		rep->consecutive_failures = sys_cpu_to_le16(MIN(sweeps - slot->gone_sweep + 1,
+								 UINT16_MAX));
+	}
+}
+
+int presence_stats_get(struct presence_report *reports, int max)
+{
+	uint32_t now = uptime_s();
+	int count;
+
+	k_mutex_lock(&stats_lock, K_FOREVER);
+	count = MIN(num_slots, max);
+	for (int i = 0; i < count; i++) {
+		slot_report(&slots[i], now, &reports[i]);
+	}
+	k_mutex_unlock(&stats_lock);
+
+	return count;
+}
+
+#if defined(CONFIG_BT)
+#define BT_UUID_I2C_STATS_SERVICE_VAL \
+	BT_UUID_128_ENCODE(0x12345678, 0x1234, 0x5678, 0x1234, 0x56789abcdef6)
+#define BT_UUID_I2C_STATS_TABLE_VAL \
+	BT_UUID_128_ENCODE(0x12345678, 0x1234, 0x5678, 0x1234, 0x56789abcdef7)
+
+#define BT_UUID_I2C_STATS_SERVICE BT_UUID_DECLARE_128(BT_UUID_I2C_STATS_SERVICE_VAL)
+#define BT_UUID_I2C_STATS_TABLE   BT_UUID_DECLARE_128(BT_UUID_I2C_STATS_TABLE_VAL)
+
+// GATT read callback for the statistics table, long reads supported
+static ssize_t read_stats(struct bt_conn *conn,
+			  const struct bt_gatt_attr *attr,
+			  void *buf, uint16_t len, uint16_t offset)
+{
+	static struct presence_report table[CONFIG_I2C_SCANNER_STATS_MAX];
+	int count;
+
+	// Snapshot once per long read so all segments are consistent
+	if (offset == 0) {
+		presence_stats_get(table, ARRAY_SIZE(table));
+	}
+	count = MIN(num_slots, CONFIG_I2C_SCANNER_STATS_MAX);
+
+	return bt_gatt_attr_read(conn, attr, buf, len, offset, table,
+				 count * sizeof(table[0]));
+}
+
+BT_GATT_SERVICE_DEFINE(i2c_stats_svc,
+	BT_GATT_PRIMARY_SERVICE(BT_UUID_I2C_STATS_SERVICE),
+	BT_GATT_CHARACTERISTIC(BT_UUID_I2C_STATS_TABLE,
+			       BT_GATT_CHRC_READ,
+			       BT_GATT_PERM_READ,
+			       read_stats, NULL, NULL),
+);
+#endif /* CONFIG_BT */
+
+#if defined(CONFIG_SHELL)
+static int cmd_stats(const struct shell *sh, size_t argc, char **argv)
+{
+	struct presence_report table[CONFIG_I2C_SCANNER_STATS_MAX];
+	int count = presence_stats_get(table, ARRAY_SIZE(table));
+
+	shell_print(sh, "addr state  first[s]  last[s]  present[s]  flaps  fails");
+	for (int i = 0; i < count; i++) {
+		const struct presence_report *rep = &table[i];
+
+		shell_print(sh, "0x%02X %-6s %8u %8u %11u %6u %6u", rep->addr,
+			    rep->present ? "up" : "down",
+			    sys_le32_to_cpu(rep->first_seen_s),
+			    sys_le32_to_cpu(rep->last_seen_s),
+			    sys_le32_to_cpu(rep->present_s),
+			    sys_le16_to_cpu(rep->transitions),
+			    sys_le16_to_cpu(rep->consecutive_failures));
+	}
+	shell_print(sh, "%d address(es) tracked over %u sweep(s)", count, sweeps);
+
+	return 0;
+}
+
+SHELL_SUBCMD_ADD((i2cscan), stats, NULL, "Per-address presence statistics",
+		 cmd_stats, 1, 0);
+#endif /* CONFIG_SHELL */
@@ -0,0 +1,41 @@
+// Per-address presence statistics
+
+#ifndef PRESENCE_STATS_H_
+#define PRESENCE_STATS_H_
+
+#include <stdint.h>
+#include <zephyr/toolchain.h>
+
+#include "scanner.h"
+
+// Statistics of one address, as read over BLE (multi-byte fields little
+// endian). Times are seconds of uptime.
+struct presence_report {
+	uint8_t addr;
+	uint8_t present;
+	uint16_t transitions;
+	uint32_t first_seen_s;
+	uint32_t last_seen_s;           // last sweep that found it present
+	uint32_t present_s;             // total time present
+	uint16_t consecutive_failures;  // sweeps missed since last seen
+} __packed;
+
+/**
+ * @brief Update the statistics with the result of a sweep
+ *
+ * Only addresses whose presence changed since the previous sweep are
+ * touched.
+ *
+ * @param state Per-address probe state of the completed sweep
+ */
+void presence_stats_update(const uint8_t state[I2C_NUM_ADDRS]);
+
+/**
+ * @brief Snapshot the statistics of all addresses seen so far
+ * @param reports Receives one entry per tracked address
+ * @param max Capacity of @p reports
+ * @return Number of entries written
+ */
+int presence_stats_get(struct presence_report *reports, int max);
+
+#endif /* PRESENCE_STATS_H_ */
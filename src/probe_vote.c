@@ -0,0 +1,84 @@
+// Multi-probe voting and per-address confidence
+//
+// Each address keeps the resolved results of its last eight sweeps as a
+// shift register. Stable addresses cost one probe per sweep as before;
+// re-probing is reserved for results that contradict the history.
+
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+
+#include "scanner.h"
+#include "probe_vote.h"
+
+LOG_MODULE_DECLARE(i2c_scanner, LOG_LEVEL_INF);
+
+#define HISTORY_DEPTH 8
+
+BUILD_ASSERT((CONFIG_I2C_SCANNER_VOTES % 2) == 1,
+	     "An odd number of votes avoids ties");
+
+// Bit n set if the address was present n sweeps ago
+static uint8_t history[I2C_NUM_ADDRS];
+static uint8_t history_len[I2C_NUM_ADDRS];
+
+static void history_push(uint8_t addr, bool present)
+{
+	history[addr] = (history[addr] << 1) | (present ? 1 : 0);
+	if (history_len[addr] < HISTORY_DEPTH) {
+		history_len[addr]++;
+	}
+}
+
+static bool history_majority(uint8_t addr)
+{
+	uint8_t mask = BIT_MASK(history_len[addr]);
+
+	return popcount(history[addr] & mask) * 2 > history_len[addr];
+}
+
+bool probe_vote_resolve(uint8_t addr, bool present)
+{
+	int votes = 1;
+	int present_votes = present ? 1 : 0;
+	bool result;
+
+	if (history_len[addr] == 0 || present == history_majority(addr)) {
+		history_push(addr, present);
+		return present;
+	}
+
+	for (; votes < CONFIG_I2C_SCANNER_VOTES; votes++) {
+		if (test_i2c_address(addr) == 0) {
+			present_votes++;
+		}
+	}
+
+	result = present_votes * 2 > votes;
+
+	if (present_votes == 0 || present_votes == votes) {
+		// Every probe agrees on the change: hot-plug, forget the
+		// old history so confidence reflects the new state
+		LOG_INF("0x%02X %s", addr, result ? "attached" : "detached");
+		history_len[addr] = 0;
+	} else {
+		LOG_WRN("0x%02X flaky: %d of %d probes present", addr,
+			present_votes, votes);
+	}
+
+	history_push(addr, result);
+	return result;
+}
+
+uint8_t probe_vote_confidence(uint8_t addr)
+{
+	uint8_t len = history_len[addr];
+	uint8_t bits = history[addr] & BIT_MASK(len);
+	int agree;
+
+	if (len == 0) {
+		return 0;
+	}
+
+	agree = (bits & 1) ? popcount(bits) : len - popcount(bits);
+	return (agree * 100) / len;
+}
@@ -0,0 +1,30 @@
+// Multi-probe voting and per-address confidence
+
+#ifndef PROBE_VOTE_H_
+#define PROBE_VOTE_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/**
+ * @brief Resolve the result of a probe against the address history
+ *
+ * A result that agrees with the majority of the recent history is accepted
+ * as is. Only a disagreeing result triggers extra probes and a majority
+ * vote: a unanimous vote is taken as a real hot-plug, a split vote marks
+ * the address as flaky.
+ *
+ * @param addr Probed address
+ * @param present Result of the first probe
+ * @return Resolved presence
+ */
+bool probe_vote_resolve(uint8_t addr, bool present);
+
+/**
+ * @brief Confidence in the current state of an address
+ * @param addr Address to query
+ * @return Percentage of the recent results agreeing with the latest one
+ */
+uint8_t probe_vote_confidence(uint8_t addr);
+
+#endif /* PROBE_VOTE_H_ */
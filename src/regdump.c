@@ -0,0 +1,347 @@
+// Register map dumps with sparse run-length encoding
+//
+// Most register-mapped devices auto-increment the register pointer on
+// sequential reads, so a whole map costs a few burst transfers. This is
+// verified per device by comparing a short burst with single register reads
+// before trusting it. Register maps are mostly zeros and reset values, so
+// the encoded form (runs of one value, literal blocks otherwise) is usually
+// a fraction of the raw size on the radio.
+
+#include <zephyr/kernel.h>
+#include <zephyr/drivers/i2c.h>
+#include <zephyr/logging/log.h>
+#include <zephyr/sys/byteorder.h>
+#include <zephyr/sys/crc.h>
+#include <string.h>
+
+#include "scanner.h"
+#include "bus_share.h"
+#include "dump_stream.h"
+#include "golden.h"
+#include "regdump.h"
+
+LOG_MODULE_DECLARE(i2c_scanner, LOG_LEVEL_INF);
+
+// Registers compared when checking for auto-increment
+#define AUTOINC_CHECK_LEN 8
+
+// Shortest run worth encoding as a run block
+#define RLE_MIN_RUN 3
+
+static uint8_t regs[CONFIG_I2C_SCANNER_REGDUMP_MAX];
+// Worst case: one control byte per REGDUMP_RLE_MAX_LEN literal bytes
+static uint8_t encoded[CONFIG_I2C_SCANNER_REGDUMP_MAX +
+		       DIV_ROUND_UP(CONFIG_I2C_SCANNER_REGDUMP_MAX, REGDUMP_RLE_MAX_LEN)];
+
+static struct regdump_request pending;
+static atomic_t busy;
+
+/**
+ * @brief Read @p len registers starting at @p reg in one transfer
+ *
+ * With bus sharing, each read is taken between application transfers like a
+ * probe, so dumps, golden comparisons and fingerprints share its budget.
+ */
+static int read_regs(uint8_t addr, uint8_t reg_width, uint16_t reg,
+		     uint8_t *buf, size_t len)
+{
+	uint8_t wbuf[2];
+	int ret;
+
+	if (reg_width == 1) {
+		wbuf[0] = reg;
+	} else {
+		sys_put_be16(reg, wbuf);
+	}
+
+	if (IS_ENABLED(CONFIG_I2C_SCANNER_SHARE)) {
+		bus_share_probe_begin();
+	}
+
+	ret = i2c_write_read(i2c_dev, addr, wbuf, reg_width == 1 ? 1 : 2, buf, len);
+
+	if (IS_ENABLED(CONFIG_I2C_SCANNER_SHARE)) {
+		bus_share_probe_end();
+	}
+
+	return ret;
+}
+
+/**
+ * @brief Check whether a burst read returns consecutive registers
+ * @return 1 if it does, 0 if not, negative error code on bus error
+ */
+static int check_autoincrement(const struct regdump_request *req)
+{
+	uint8_t burst[AUTOINC_CHECK_LEN];
+	size_t len = MIN(req->count, AUTOINC_CHECK_LEN);
+	int mismatches = 0;
+	int first_match = -1;
+	bool differing = false;
+	int ret;
+
+	if (len < 2) {
+		return 0;
+	}
+
+	ret = read_regs(req->addr, req->reg_width, req->start, burst, len);
+	if (ret < 0) {
+		return ret;
+	}
+
+	for (size_t i = 0; i < len; i++) {
+		uint8_t single;
+
+		ret = read_regs(req->addr, req->reg_width, req->start + i, &single, 1);
+		if (ret < 0) {
+			return ret;
+		}
+		if (single != burst[i]) {
+			mismatches++;
+		} else if (first_match < 0) {
+			first_match = single;
+		} else if (single != first_match) {
+			differing = true;
+		}
+	}
+
+	// A uniform map reads the same whether or not the pointer advances, so
+	// only matching values that differ from each other prove the burst.
+	// One volatile register (status, counter) may differ when there are
+	// enough others to compare against.
+	return differing && mismatches <= (len > 2 ? 1 : 0);
+}
+
+/**
+ * @brief Run-length encode a register map
+ * @param in Register values
+ * @param len Number of registers
+ * @param out Receives the encoded blocks
+ * @return Encoded length in bytes
+ */
+static size_t rle_encode(const uint8_t *in, size_t len, uint8_t *out)
+{
+	size_t o = 0;
+	size_t i = 0;
+
+	while (i < len) {
+		size_t run = 1;
+
+		while (i + run < len && run < REGDUMP_RLE_MAX_LEN &&
+		       in[i + run] == in[i]) {
+			run++;
+		}
+
+		if (run >= RLE_MIN_RUN) {
+			out[o++] = REGDUMP_RLE_RUN | (run - 1);
+			out[o++] = in[i];
+			i += run;
+			continue;
+		}
+
+		// Literal block up to the next worthwhile run
+		size_t lit = 0;
+
+		while (i + lit < len && lit < REGDUMP_RLE_MAX_LEN) {
+			if (i + lit + RLE_MIN_RUN <= len &&
+			    in[i + lit] == in[i + lit + 1] &&
+			    in[i + lit] == in[i + lit + 2]) {
+				break;
+			}
+			lit++;
+		}
+
+		out[o++] = lit - 1;
+		memcpy(&out[o], &in[i], lit);
+		o += lit;
+		i += lit;
+	}
+
+	return o;
+}
+
+/**
+ * @brief Fingerprint a chip for golden snapshot lookup
+ *
+ * Covers the address, the dumped range and the value of the chip ID
+ * register, so a different part or a different register window never
+ * matches another chip's snapshot.
+ *
+ * @param req Dump request
+ * @param fingerprint Receives the fingerprint
+ * @return 0 on success, negative error code otherwise
+ */
+static int chip_fingerprint(const struct regdump_request *req, uint32_t *fingerprint)
+{
+	uint8_t key[8];
+	int ret;
+
+	key[0] = req->addr;
+	key[1] = req->reg_width;
+	sys_put_le16(req->start, &key[2]);
+	sys_put_le16(req->count, &key[4]);
+	key[6] = 0;
+
+	ret = read_regs(req->addr, req->reg_width, req->id_reg, &key[7], 1);
+	if (ret < 0) {
+		return ret;
+	}
+
+	*fingerprint = crc32_ieee(key, sizeof(key));
+	return 0;
+}
+
+static bool request_is_valid(const struct regdump_request *req)
+{
+	return req->count > 0 && req->count <= CONFIG_I2C_SCANNER_REGDUMP_MAX &&
+	       (req->reg_width == 1 || req->reg_width == 2) &&
+	       (req->reg_width != 1 || req->start + req->count <= 0x100);
+}
+
+/**
+ * @brief Store an uploaded register map as the golden snapshot
+ *
+ * The map is filed under the fingerprint of the chip at the request address,
+ * exactly as a local REGDUMP_MODE_SAVE_GOLDEN capture would be.
+ *
+ * @param req Upload request, the register values are in regs[]
+ * @return 0 on success, negative error code otherwise
+ */
+static int regdump_load_golden(const struct regdump_request *req)
+{
+	uint32_t fingerprint;
+	int ret;
+
+	if (!request_is_valid(req)) {
+		return -EINVAL;
+	}
+
+	ret = chip_fingerprint(req, &fingerprint);
+	if (ret < 0) {
+		LOG_ERR("Fingerprint of 0x%02X failed: %d", req->addr, ret);
+		return ret;
+	}
+
+	LOG_INF("Uploaded golden snapshot for 0x%02X, %u registers", req->addr,
+		req->count);
+	return golden_save(fingerprint, regs, req->count);
+}
+
+int regdump_device(const struct regdump_request *req)
+{
+	uint32_t fingerprint;
+	int64_t start_ms = k_uptime_get();
+	size_t enc_len;
+	int autoinc;
+	int ret = 0;
+
+	if (!request_is_valid(req) || req->mode > REGDUMP_MODE_SAVE_GOLDEN) {
+		return -EINVAL;
+	}
+
+	autoinc = check_autoincrement(req);
+	if (autoinc < 0) {
+		LOG_ERR("Register dump of 0x%02X failed: %d", req->addr, autoinc);
+		return autoinc;
+	}
+
+	if (autoinc) {
+		for (size_t i = 0; i < req->count && ret == 0;
+		     i += CONFIG_I2C_SCANNER_REGDUMP_BURST) {
+			ret = read_regs(req->addr, req->reg_width, req->start + i, &regs[i],
+					MIN(CONFIG_I2C_SCANNER_REGDUMP_BURST, req->count - i));
+		}
+	} else {
+		for (size_t i = 0; i < req->count && ret == 0; i++) {
+			ret = read_regs(req->addr, req->reg_width, req->start + i,
+					&regs[i], 1);
+		}
+	}
+	if (ret < 0) {
+		LOG_ERR("Register dump of 0x%02X failed: %d", req->addr, ret);
+		return ret;
+	}
+
+	if (IS_ENABLED(CONFIG_I2C_SCANNER_GOLDEN) && req->mode != REGDUMP_MODE_DUMP) {
+		ret = chip_fingerprint(req, &fingerprint);
+		if (ret < 0) {
+			LOG_ERR("Fingerprint of 0x%02X failed: %d", req->addr, ret);
+			return ret;
+		}
+
+		if (req->mode == REGDUMP_MODE_SAVE_GOLDEN) {
+			return golden_save(fingerprint, regs, req->count);
+		}
+
+		ret = golden_compare(fingerprint, req->addr, req->start, regs, req->count);
+		return ret < 0 ? ret : 0;
+	}
+
+	printk("Registers of 0x%02X (%s):\n", req->addr,
+	       autoinc ? "burst" : "single reads");
+	for (size_t i = 0; i < req->count; i++) {
+		if ((i % 16) == 0) {
+			printk("%s%04X:", i ? "\n" : "", (unsigned int)(req->start + i));
+		}
+		printk(" %02X", regs[i]);
+	}
+	printk("\n");
+
+	enc_len = rle_encode(regs, req->count, encoded);
+	dump_stream_notify(DUMP_TYPE_REGMAP_RLE, req->addr, req->start, encoded, enc_len);
+	dump_stream_end(DUMP_TYPE_REGMAP_RLE, req->addr, req->count);
+
+	LOG_INF("Register dump of 0x%02X: %u registers in %u ms, %u bytes encoded",
+		req->addr, req->count, (uint32_t)(k_uptime_get() - start_ms),
+		(unsigned int)enc_len);
+	return 0;
+}
+
+static void regdump_work_handler(struct k_work *work)
+{
+	if (IS_ENABLED(CONFIG_I2C_SCANNER_GOLDEN) &&
+	    pending.mode == REGDUMP_MODE_LOAD_GOLDEN) {
+		regdump_load_golden(&pending);
+	} else {
+		regdump_device(&pending);
+	}
+	atomic_clear(&busy);
+}
+
+static K_WORK_DEFINE(regdump_work, regdump_work_handler);
+
+int regdump_submit(const struct regdump_request *req, const uint8_t *data,
+		   size_t len)
+{
+	struct regdump_request r = {
+		.addr = req->addr,
+		.reg_width = req->reg_width,
+		.start = sys_le16_to_cpu(req->start),
+		.count = sys_le16_to_cpu(req->count),
+		.mode = req->mode,
+		.id_reg = sys_le16_to_cpu(req->id_reg),
+	};
+
+	if (!request_is_valid(&r) || r.mode > REGDUMP_MODE_LOAD_GOLDEN) {
+		return -EINVAL;
+	}
+
+	if (len != (r.mode == REGDUMP_MODE_LOAD_GOLDEN ? r.count : 0)) {
+		return -EMSGSIZE;
+	}
+
+	if (r.mode != REGDUMP_MODE_DUMP && !IS_ENABLED(CONFIG_I2C_SCANNER_GOLDEN)) {
+		return -ENOTSUP;
+	}
+
+	if (!atomic_cas(&busy, 0, 1)) {
+		return -EBUSY;
+	}
+
+	pending = r;
+	if (len > 0) {
+		memcpy(regs, data, len);
+	}
+	k_work_submit(&regdump_work);
+	return 0;
+}
@@ -0,0 +1,66 @@
+// Register map dumps with sparse run-length encoding
+
+#ifndef REGDUMP_H_
+#define REGDUMP_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include <zephyr/toolchain.h>
+
+// What to do with a register map once it has been read
+enum regdump_mode {
+	REGDUMP_MODE_DUMP = 0,        // stream the whole map
+	REGDUMP_MODE_COMPARE,         // diff against the golden snapshot
+	REGDUMP_MODE_SAVE_GOLDEN,     // store the map as golden snapshot
+	REGDUMP_MODE_LOAD_GOLDEN,     // store the uploaded map as golden snapshot
+};
+
+// Register dump request, as written by a BLE client to the dump
+// characteristic (multi-byte fields little endian). For
+// REGDUMP_MODE_LOAD_GOLDEN the request is followed by count register values.
+struct regdump_request {
+	uint8_t addr;
+	uint8_t reg_width;      // register address bytes, 1 or 2
+	uint16_t start;
+	uint16_t count;
+	uint8_t mode;           // enum regdump_mode
+	uint16_t id_reg;        // chip ID register used for the fingerprint
+} __packed;
+
+// Encoded block control byte: bit 7 set for a run of one repeated value,
+// clear for literal bytes; bits 6-0 hold the block length minus one
+#define REGDUMP_RLE_RUN     BIT(7)
+#define REGDUMP_RLE_MAX_LEN 128
+
+/**
+ * @brief Dump a register range of one device
+ *
+ * Registers are fetched with auto-increment burst reads when the device
+ * supports them and one by one otherwise. Depending on the request mode the
+ * map is printed on the console and streamed run-length encoded as a
+ * DUMP_TYPE_REGMAP_RLE dump, compared with its golden snapshot, or stored as
+ * the golden snapshot.
+ *
+ * @param req Device and register range to dump
+ * @return 0 on success, negative error code otherwise
+ */
+int regdump_device(const struct regdump_request *req);
+
+/**
+ * @brief Queue a register dump on the system work queue
+ *
+ * A REGDUMP_MODE_LOAD_GOLDEN request carries an externally captured map in
+ * @p data. It is checked like a local capture (register range, chip answering
+ * at the fingerprint register) and stored under the fingerprint of the chip
+ * that is actually present.
+ *
+ * @param req Device and register range to dump
+ * @param data Register values for REGDUMP_MODE_LOAD_GOLDEN, NULL otherwise
+ * @param len Number of bytes in @p data
+ * @return 0 on success, -EBUSY if a dump is pending, -EMSGSIZE if @p len does
+ *         not match the request, -EINVAL if invalid
+ */
+int regdump_submit(const struct regdump_request *req, const uint8_t *data,
+		   size_t len);
+
+#endif /* REGDUMP_H_ */
@@ -0,0 +1,44 @@
+// Adaptive full-sweep cadence
+//
+// A bus that has not changed for a while is unlikely to change in the next
+// few seconds, so the sweep period backs off exponentially while results
+// are stable. Any change, or a client connecting and wanting fresh data,
+// snaps it back to the minimum period.
+
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+
+#include "scan_cadence.h"
+
+LOG_MODULE_DECLARE(i2c_scanner, LOG_LEVEL_INF);
+
+BUILD_ASSERT(CONFIG_I2C_SCANNER_CADENCE_MIN_MS <= CONFIG_I2C_SCANNER_CADENCE_MAX_MS,
+	     "Minimum scan period above the maximum");
+
+static uint32_t period_ms = CONFIG_I2C_SCANNER_CADENCE_MIN_MS;
+static atomic_t kicked;
+static K_SEM_DEFINE(wake_sem, 0, 1);
+
+uint32_t scan_cadence_next(bool changed)
+{
+	if (atomic_clear(&kicked) || changed) {
+		period_ms = CONFIG_I2C_SCANNER_CADENCE_MIN_MS;
+	} else {
+		period_ms = MIN(period_ms * 2, CONFIG_I2C_SCANNER_CADENCE_MAX_MS);
+	}
+
+	return period_ms;
+}
+
+void scan_cadence_wait(uint32_t period)
+{
+	if (k_sem_take(&wake_sem, K_MSEC(period)) == 0) {
+		LOG_INF("Scan requested early");
+	}
+}
+
+void scan_cadence_kick(void)
+{
+	atomic_set(&kicked, 1);
+	k_sem_give(&wake_sem);
+}
@@ -0,0 +1,37 @@
+// Adaptive full-sweep cadence
+
+#ifndef SCAN_CADENCE_H_
+#define SCAN_CADENCE_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/**
+ * @brief Work out the delay before the next sweep
+ *
+ * The period doubles after every sweep that found the bus unchanged, up
+ * to CONFIG_I2C_SCANNER_CADENCE_MAX_MS, and drops back to
+ * CONFIG_I2C_SCANNER_CADENCE_MIN_MS after a change.
+ *
+ * @param changed Whether the last sweep differed from the one before
+ * @return Delay in milliseconds
+ */
+uint32_t scan_cadence_next(bool changed);
+
+/**
+ * @brief Wait for the next sweep
+ *
+ * Returns early if scan_cadence_kick() is called meanwhile.
+ *
+ * @param period_ms Delay from scan_cadence_next()
+ */
+void scan_cadence_wait(uint32_t period_ms);
+
+/**
+ * @brief Return to the fast cadence and start the next sweep right away
+ *
+ * Safe to call from any context, e.g. a BLE connection callback.
+ */
+void scan_cadence_kick(void);
+
+#endif /* SCAN_CADENCE_H_ */
@@ -0,0 +1,98 @@
+// Progressive BLE notification of sweep results
+//
+// The scan result characteristic is only updated once the whole scan is
+// done, which on a slow bus or with the 10-bit sweep takes seconds. Devices
+// are also queued here as they are found and notified at the end of every
+// sweep row (or 10-bit progress step) that found any, so a subscribed
+// client sees the first devices almost immediately. A notification flagged
+// SCAN_PROGRESS_COMPLETE closes each scan.
+
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+#include <zephyr/sys/byteorder.h>
+#include <zephyr/bluetooth/bluetooth.h>
+#include <zephyr/bluetooth/uuid.h>
+#include <zephyr/bluetooth/gatt.h>
+
+#include "scan_progress.h"
+
+LOG_MODULE_DECLARE(i2c_scanner, LOG_LEVEL_INF);
+
+#define BT_UUID_I2C_PROGRESS_SERVICE_VAL \
+	BT_UUID_128_ENCODE(0x12345678, 0x1234, 0x5678, 0x1234, 0x56789abcdef8)
+#define BT_UUID_I2C_PROGRESS_DATA_VAL \
+	BT_UUID_128_ENCODE(0x12345678, 0x1234, 0x5678, 0x1234, 0x56789abcdef9)
+
+#define BT_UUID_I2C_PROGRESS_SERVICE BT_UUID_DECLARE_128(BT_UUID_I2C_PROGRESS_SERVICE_VAL)
+#define BT_UUID_I2C_PROGRESS_DATA    BT_UUID_DECLARE_128(BT_UUID_I2C_PROGRESS_DATA_VAL)
+
+static bool subscribed;
+
+static void progress_ccc_changed(const struct bt_gatt_attr *attr, uint16_t value)
+{
+	subscribed = (value == BT_GATT_CCC_NOTIFY);
+}
+
+BT_GATT_SERVICE_DEFINE(i2c_progress_svc,
+	BT_GATT_PRIMARY_SERVICE(BT_UUID_I2C_PROGRESS_SERVICE),
+	BT_GATT_CHARACTERISTIC(BT_UUID_I2C_PROGRESS_DATA,
+			       BT_GATT_CHRC_NOTIFY,
+			       BT_GATT_PERM_NONE,
+			       NULL, NULL, NULL),
+	BT_GATT_CCC(progress_ccc_changed, BT_GATT_PERM_READ | BT_GATT_PERM_WRITE),
+);
+
+static struct {
+	struct scan_progress_hdr hdr;
+	uint16_t addrs[SCAN_PROGRESS_MAX_ADDRS];
+} __packed msg;
+static int queued;
+static uint8_t seq;
+
+static void progress_notify(uint16_t next_addr, uint8_t flags)
+{
+	int err;
+
+	msg.hdr.seq = seq++;
+	msg.hdr.flags = flags;
+	msg.hdr.next_addr = sys_cpu_to_le16(next_addr);
+
+	err = bt_gatt_notify(NULL, &i2c_progress_svc.attrs[1], &msg,
+			     sizeof(msg.hdr) + queued * sizeof(msg.addrs[0]));
+	if (err && err != -ENOTCONN) {
+		LOG_ERR("Progress notify failed (err %d)", err);
+	}
+	queued = 0;
+}
+
+void scan_progress_begin(void)
+{
+	seq = 0;
+	queued = 0;
+}
+
+void scan_progress_add(uint16_t addr, uint8_t flags)
+{
+	if (!subscribed) {
+		return;
+	}
+
+	msg.addrs[queued++] = sys_cpu_to_le16(addr);
+	if (queued == SCAN_PROGRESS_MAX_ADDRS) {
+		progress_notify(addr + 1, flags);
+	}
+}
+
+void scan_progress_flush(uint16_t next_addr, uint8_t flags)
+{
+	if (subscribed && queued > 0) {
+		progress_notify(next_addr, flags);
+	}
+}
+
+void scan_progress_end(uint8_t flags)
+{
+	if (subscribed) {
+		progress_notify(0, SCAN_PROGRESS_COMPLETE | flags);
+	}
+}
@@ -0,0 +1,58 @@
+// Progressive BLE notification of sweep results
+
+#ifndef SCAN_PROGRESS_H_
+#define SCAN_PROGRESS_H_
+
+#include <stdint.h>
+#include <zephyr/sys/util.h>
+#include <zephyr/toolchain.h>
+
+// Flags of a progress notification
+#define SCAN_PROGRESS_10BIT     BIT(0)  // addresses are 10-bit
+#define SCAN_PROGRESS_COMPLETE  BIT(1)  // last notification of the scan
+#define SCAN_PROGRESS_EARLY_EXIT BIT(2) // scan completed by early exit
+
+// Addresses carried by one notification, sized for the default ATT MTU
+#define SCAN_PROGRESS_MAX_ADDRS 8
+
+// Progress notification: the header is followed by up to
+// SCAN_PROGRESS_MAX_ADDRS little endian addresses found since the previous
+// notification. next_addr is the first address not yet probed.
+struct scan_progress_hdr {
+	uint8_t seq;            // incremented per notification, 0 at scan start
+	uint8_t flags;
+	uint16_t next_addr;     // little endian
+} __packed;
+
+/**
+ * @brief Start reporting a new scan
+ */
+void scan_progress_begin(void);
+
+/**
+ * @brief Queue a device found by the sweep
+ *
+ * A full batch is notified right away.
+ *
+ * @param addr Address of the device
+ * @param flags SCAN_PROGRESS_10BIT for a 10-bit address, 0 otherwise
+ */
+void scan_progress_add(uint16_t addr, uint8_t flags);
+
+/**
+ * @brief Notify the queued devices, if any
+ * @param next_addr First address not probed yet
+ * @param flags SCAN_PROGRESS_10BIT for a 10-bit address, 0 otherwise
+ */
+void scan_progress_flush(uint16_t next_addr, uint8_t flags);
+
+/**
+ * @brief Mark the scan complete
+ *
+ * Called after the final scan_progress_flush() of the scan.
+ *
+ * @param flags SCAN_PROGRESS_EARLY_EXIT if the sweep stopped early, 0 otherwise
+ */
+void scan_progress_end(uint8_t flags);
+
+#endif /* SCAN_PROGRESS_H_ */
@@ -0,0 +1,44 @@
+// Scan result as exposed over BLE, shared with the gateway central
+
+#ifndef SCAN_RESULT_H_
+#define SCAN_RESULT_H_
+
+#include <zephyr/toolchain.h>
+#include <zephyr/sys/util_macro.h>
+#include <zephyr/bluetooth/uuid.h>
+#include <stdint.h>
+
+// BLE UUIDs - Custom service for I2C Scanner
+#define BT_UUID_I2C_SCANNER_SERVICE_VAL \
+	BT_UUID_128_ENCODE(0x12345678, 0x1234, 0x5678, 0x1234, 0x56789abcdef0)
+#define BT_UUID_I2C_SCAN_RESULT_VAL \
+	BT_UUID_128_ENCODE(0x12345678, 0x1234, 0x5678, 0x1234, 0x56789abcdef1)
+
+#define BT_UUID_I2C_SCANNER_SERVICE BT_UUID_DECLARE_128(BT_UUID_I2C_SCANNER_SERVICE_VAL)
+#define BT_UUID_I2C_SCAN_RESULT     BT_UUID_DECLARE_128(BT_UUID_I2C_SCAN_RESULT_VAL)
+
+// Number of addresses carried in one result
+#define SCAN_RESULT_MAX_ADDRS 10
+
+// Scan result characteristic value, all fields little endian
+// declared_mask has bit i set when addresses[i] is declared in devicetree;
+// complete_us is the uptime at which the sweep completed, in microseconds
+// (low 32 bits), so clients sharing the clock can measure the delivery
+// latency. count_10bit, appended after the fields older clients know, is
+// the number of devices the 10-bit sweep found; they are not listed in
+// addresses
+struct i2c_scan_result {
+	uint8_t device_count;
+	uint8_t addresses[SCAN_RESULT_MAX_ADDRS];
+	uint16_t declared_mask;
+	uint8_t flags;
+	uint32_t complete_us;
+	uint8_t count_10bit;
+} __packed;
+
+// Scan result flags
+#define SCAN_RESULT_EARLY_EXIT    BIT(0)  // sweep ended once the expected set was confirmed
+#define SCAN_RESULT_10BIT         BIT(1)  // 10-bit sweep ran, count_10bit is valid
+#define SCAN_RESULT_10BIT_UNKNOWN BIT(2)  // every 10-bit probe NACKed, support unknown
+
+#endif /* SCAN_RESULT_H_ */
@@ -0,0 +1,41 @@
+// Shared definitions for the I2C scanner modules
+
+#ifndef SCANNER_H_
+#define SCANNER_H_
+
+#include <zephyr/device.h>
+#include <stdint.h>
+
+// I2C address range to scan
+// Addresses 0x00-0x07 and 0x78-0x7F are reserved. When reserved probing is
+// enabled only the general call (0x00) and the Device ID addresses
+// (0x7C-0x7F) are still skipped.
+#if defined(CONFIG_I2C_SCANNER_RESERVED)
+#define I2C_SCAN_START  0x01
+#define I2C_SCAN_END    0x7B
+#else
+#define I2C_SCAN_START  0x08
+#define I2C_SCAN_END    0x77
+#endif
+
+// Number of 7-bit addresses, used to size per-address tables
+#define I2C_NUM_ADDRS   128
+
+// Per-address probe state used during a single scan
+enum probe_state {
+	PROBE_UNKNOWN = 0,
+	PROBE_ABSENT,
+	PROBE_PRESENT,
+};
+
+// Scanned I2C bus
+extern const struct device *i2c_dev;
+
+/**
+ * @brief Test if a device exists at the given I2C address
+ * @param addr I2C address to test
+ * @return 0 if device found, negative error code otherwise
+ */
+int test_i2c_address(uint8_t addr);
+
+#endif /* SCANNER_H_ */
@@ -0,0 +1,143 @@
+// SMBALERT# interrupt handling
+//
+// The SMBALERT# line is wired to a GPIO. On assertion the Alert Response
+// Address is read until no device answers any more, which identifies every
+// alerting device in one or two transactions each instead of waiting for the
+// next full sweep. The level interrupt is only re-armed once the line has
+// been released; a line that stays asserted is retried with an increasing
+// delay instead of re-triggering immediately.
+
+#include <zephyr/kernel.h>
+#include <zephyr/drivers/gpio.h>
+#include <zephyr/drivers/i2c.h>
+#include <zephyr/logging/log.h>
+
+#include "scanner.h"
+#include "bus_share.h"
+#include "smbus_special.h"
+#include "smbus_alert.h"
+
+LOG_MODULE_DECLARE(i2c_scanner, LOG_LEVEL_INF);
+
+#define ZEPHYR_USER_NODE DT_PATH(zephyr_user)
+
+BUILD_ASSERT(DT_NODE_HAS_PROP(ZEPHYR_USER_NODE, smbalert_gpios),
+	     "CONFIG_I2C_SCANNER_SMBUS_ALERT needs smbalert-gpios in zephyr,user");
+
+// Upper bound on devices served per interrupt, protects against a stuck line
+#define MAX_ALERTS_PER_IRQ 8
+
+// Retry delay bounds while SMBALERT# stays asserted after being served
+#define STUCK_BACKOFF_MIN_MS 10
+#define STUCK_BACKOFF_MAX_MS 5000
+
+static const struct gpio_dt_spec smbalert =
+	GPIO_DT_SPEC_GET(ZEPHYR_USER_NODE, smbalert_gpios);
+
+static struct gpio_callback smbalert_cb;
+static struct k_work_delayable smbalert_work;
+static uint32_t irq_cycles;     // start of the current attempt
+static uint32_t stuck_backoff_ms;
+
+static void smbalert_work_handler(struct k_work *work)
+{
+	uint8_t alerter;
+	uint8_t data;
+	int served = 0;
+	int ret;
+
+	// A retry measures from its own start, the backoff before it is
+	// logged separately when it is scheduled
+	if (stuck_backoff_ms > 0) {
+		irq_cycles = k_cycle_get_32();
+	}
+
+	while (served < MAX_ALERTS_PER_IRQ &&
+	       smbus_read_alert_response(&alerter) == 0) {
+		uint32_t us = k_cyc_to_us_floor32(k_cycle_get_32() - irq_cycles);
+
+		// Read just the device that asserted the alert
+		if (IS_ENABLED(CONFIG_I2C_SCANNER_SHARE)) {
+			bus_share_probe_begin();
+		}
+		ret = i2c_read(i2c_dev, &data, 1, alerter);
+		if (IS_ENABLED(CONFIG_I2C_SCANNER_SHARE)) {
+			bus_share_probe_end();
+		}
+
+		if (ret == 0) {
+			LOG_INF("SMBALERT from 0x%02X (data 0x%02X), identified in %u us",
+				alerter, data, us);
+		} else {
+			LOG_WRN("SMBALERT from 0x%02X, device read failed", alerter);
+		}
+		served++;
+	}
+
+	if (served == 0) {
+		LOG_WRN("SMBALERT asserted but no device answered the ARA");
+	}
+
+	// Re-enable the interrupt only after the line has been released,
+	// otherwise the level interrupt would fire again straight away
+	if (!smbus_alert_asserted()) {
+		stuck_backoff_ms = 0;
+		gpio_pin_interrupt_configure_dt(&smbalert, GPIO_INT_LEVEL_ACTIVE);
+		return;
+	}
+
+	stuck_backoff_ms = CLAMP(stuck_backoff_ms * 2, STUCK_BACKOFF_MIN_MS,
+				 STUCK_BACKOFF_MAX_MS);
+	LOG_WRN("SMBALERT# still asserted after serving %d device(s), retrying in %u ms",
+		served, stuck_backoff_ms);
+	k_work_schedule(&smbalert_work, K_MSEC(stuck_backoff_ms));
+}
+
+static void smbalert_isr(const struct device *port, struct gpio_callback *cb,
+			 gpio_port_pins_t pins)
+{
+	irq_cycles = k_cycle_get_32();
+
+	// Level interrupt: mask it until the work item has served the alert
+	gpio_pin_interrupt_configure_dt(&smbalert, GPIO_INT_DISABLE);
+	k_work_reschedule(&smbalert_work, K_NO_WAIT);
+}
+
+bool smbus_alert_asserted(void)
+{
+	return gpio_pin_get_dt(&smbalert) > 0;
+}
+
+int smbus_alert_init(void)
+{
+	int ret;
+
+	if (!gpio_is_ready_dt(&smbalert)) {
+		LOG_ERR("SMBALERT GPIO device not ready!");
+		return -ENODEV;
+	}
+
+	ret = gpio_pin_configure_dt(&smbalert, GPIO_INPUT);
+	if (ret < 0) {
+		LOG_ERR("Failed to configure SMBALERT GPIO: %d", ret);
+		return ret;
+	}
+
+	k_work_init_delayable(&smbalert_work, smbalert_work_handler);
+	gpio_init_callback(&smbalert_cb, smbalert_isr, BIT(smbalert.pin));
+
+	ret = gpio_add_callback_dt(&smbalert, &smbalert_cb);
+	if (ret < 0) {
+		LOG_ERR("Failed to add SMBALERT callback: %d", ret);
+		return ret;
+	}
+
+	ret = gpio_pin_interrupt_configure_dt(&smbalert, GPIO_INT_LEVEL_ACTIVE);
+	if (ret < 0) {
+		LOG_ERR("Failed to enable SMBALERT interrupt: %d", ret);
+		return ret;
+	}
+
+	LOG_INF("SMBALERT# monitoring on %s.%02d", smbalert.port->name, smbalert.pin);
+	return 0;
+}
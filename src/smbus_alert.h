@@ -0,0 +1,37 @@
+// SMBALERT# interrupt handling
+
+#ifndef SMBUS_ALERT_H_
+#define SMBUS_ALERT_H_
+
+#include <errno.h>
+#include <stdbool.h>
+
+#if defined(CONFIG_I2C_SCANNER_SMBUS_ALERT)
+/**
+ * @brief Enable the SMBALERT# interrupt from the zephyr,user smbalert-gpios
+ *
+ * Alerts are served from the system work queue by reading the Alert Response
+ * Address and then the alerting device, without waiting for a sweep.
+ *
+ * @return 0 on success, negative error code otherwise
+ */
+int smbus_alert_init(void);
+
+/**
+ * @brief Check whether SMBALERT# is currently asserted
+ * @return true if any device is pulling the alert line
+ */
+bool smbus_alert_asserted(void);
+#else
+static inline int smbus_alert_init(void)
+{
+	return -ENOTSUP;
+}
+
+static inline bool smbus_alert_asserted(void)
+{
+	return false;
+}
+#endif
+
+#endif /* SMBUS_ALERT_H_ */
@@ -0,0 +1,149 @@
+// SMBus special addresses and I2C Device ID reads
+//
+// Plain one byte reads are not meaningful for every reserved address: the
+// Alert Response Address returns the address of the alerting device, and
+// the Device ID address takes the target address as a write before the
+// 3-byte ID can be read back with a repeated start.
+//
+// When the SMBALERT# handler is enabled it owns the Alert Response Address:
+// the sweep only probes 0x0C while the alert line is idle, where an answer can
+// only come from an ordinary device at that address.
+//
+// With bus sharing, these reads are taken between application transfers and
+// charged to the probe budget like any other probe.
+
+#include <zephyr/kernel.h>
+#include <zephyr/drivers/i2c.h>
+#include <zephyr/logging/log.h>
+
+#include "scanner.h"
+#include "bus_share.h"
+#include "smbus_special.h"
+#include "smbus_alert.h"
+
+LOG_MODULE_DECLARE(i2c_scanner, LOG_LEVEL_INF);
+
+int smbus_read_alert_response(uint8_t *alerter)
+{
+	uint8_t data;
+	int ret;
+
+	if (IS_ENABLED(CONFIG_I2C_SCANNER_SHARE)) {
+		bus_share_probe_begin();
+	}
+
+	ret = i2c_read(i2c_dev, &data, 1, SMBUS_ADDR_ALERT_RESPONSE);
+
+	if (IS_ENABLED(CONFIG_I2C_SCANNER_SHARE)) {
+		bus_share_probe_end();
+	}
+
+	if (ret == 0) {
+		*alerter = data >> 1;
+	}
+
+	return ret;
+}
+
+void smbus_probe_special(uint8_t state[I2C_NUM_ADDRS])
+{
+	uint8_t alerter;
+
+	if (test_i2c_address(SMBUS_ADDR_HOST) == 0) {
+		state[SMBUS_ADDR_HOST] = PROBE_PRESENT;
+		LOG_INF("0x%02X: SMBus host (another controller on the bus)",
+			SMBUS_ADDR_HOST);
+	} else {
+		state[SMBUS_ADDR_HOST] = PROBE_ABSENT;
+	}
+
+	if (IS_ENABLED(CONFIG_I2C_SCANNER_SMBUS_ALERT)) {
+		if (smbus_alert_asserted()) {
+			// Reading the ARA now would release the alert before
+			// the SMBALERT# handler gets to it
+			state[SMBUS_ADDR_ALERT_RESPONSE] = PROBE_ABSENT;
+			LOG_INF("0x%02X: alert pending, left to the SMBALERT# handler",
+				SMBUS_ADDR_ALERT_RESPONSE);
+		} else if (test_i2c_address(SMBUS_ADDR_ALERT_RESPONSE) == 0) {
+			state[SMBUS_ADDR_ALERT_RESPONSE] = PROBE_PRESENT;
+		} else {
+			state[SMBUS_ADDR_ALERT_RESPONSE] = PROBE_ABSENT;
+		}
+	} else if (smbus_read_alert_response(&alerter) == 0) {
+		state[SMBUS_ADDR_ALERT_RESPONSE] = PROBE_PRESENT;
+		LOG_INF("0x%02X: SMBus alert pending from 0x%02X",
+			SMBUS_ADDR_ALERT_RESPONSE, alerter);
+	} else {
+		state[SMBUS_ADDR_ALERT_RESPONSE] = PROBE_ABSENT;
+	}
+
+	if (test_i2c_address(SMBUS_ADDR_DEVICE_DEFAULT) == 0) {
+		state[SMBUS_ADDR_DEVICE_DEFAULT] = PROBE_PRESENT;
+		LOG_INF("0x%02X: SMBus device default address (ARP capable device)",
+			SMBUS_ADDR_DEVICE_DEFAULT);
+	} else {
+		state[SMBUS_ADDR_DEVICE_DEFAULT] = PROBE_ABSENT;
+	}
+}
+
+/**
+ * @brief Read the Device ID of one target
+ * @param addr Target address
+ * @param id Receives the 3 Device ID bytes
+ * @return 0 on success, negative error code otherwise
+ */
+static int read_device_id(uint8_t addr, uint8_t id[3])
+{
+	uint8_t target = addr << 1;
+	struct i2c_msg msgs[2] = {
+		{
+			.buf = &target,
+			.len = 1,
+			.flags = I2C_MSG_WRITE,
+		},
+		{
+			.buf = id,
+			.len = 3,
+			.flags = I2C_MSG_READ | I2C_MSG_RESTART | I2C_MSG_STOP,
+		},
+	};
+
+	int ret;
+
+	if (IS_ENABLED(CONFIG_I2C_SCANNER_SHARE)) {
+		bus_share_probe_begin();
+	}
+
+	ret = i2c_transfer(i2c_dev, msgs, ARRAY_SIZE(msgs), I2C_ADDR_DEVICE_ID);
+
+	if (IS_ENABLED(CONFIG_I2C_SCANNER_SHARE)) {
+		bus_share_probe_end();
+	}
+
+	return ret;
+}
+
+int i2c_read_device_ids(const uint8_t state[I2C_NUM_ADDRS])
+{
+	int count = 0;
+
+	for (uint8_t addr = I2C_SCAN_START; addr <= I2C_SCAN_END; addr++) {
+		uint8_t id[3];
+
+		if (state[addr] != PROBE_PRESENT) {
+			continue;
+		}
+
+		if (read_device_id(addr, id) != 0) {
+			continue;
+		}
+
+		// 12-bit manufacturer, 9-bit part identification, 3-bit revision
+		LOG_INF("0x%02X: Device ID manufacturer 0x%03X part 0x%03X rev %d",
+			addr, (id[0] << 4) | (id[1] >> 4),
+			((id[1] & 0x0F) << 5) | (id[2] >> 3), id[2] & 0x07);
+		count++;
+	}
+
+	return count;
+}
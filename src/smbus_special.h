@@ -0,0 +1,49 @@
+// SMBus special addresses and I2C Device ID reads
+
+#ifndef SMBUS_SPECIAL_H_
+#define SMBUS_SPECIAL_H_
+
+#include <stdint.h>
+
+#include "scanner.h"
+
+// SMBus special addresses (SMBus 3.x, appendix C)
+#define SMBUS_ADDR_HOST            0x08
+#define SMBUS_ADDR_ALERT_RESPONSE  0x0C
+#define SMBUS_ADDR_DEVICE_DEFAULT  0x61
+
+// Reserved I2C address used for Device ID reads (UM10204, 3.1.17)
+#define I2C_ADDR_DEVICE_ID         0x7C
+
+/**
+ * @brief Read the Alert Response Address
+ *
+ * Every device asserting SMBALERT# takes part in the address arbitration; the
+ * lowest address wins and releases its alert.
+ *
+ * @param alerter Set to the 7-bit address of the device that answered
+ * @return 0 if a device answered, negative error code otherwise
+ */
+int smbus_read_alert_response(uint8_t *alerter);
+
+/**
+ * @brief Probe the SMBus special addresses with their proper semantics
+ *
+ * Fills @p state for the special addresses so the regular sweep does not
+ * probe them again. The Alert Response Address is read rather than just
+ * probed, reporting which device answered. With the SMBALERT# handler
+ * enabled, 0x0C is instead probed as an ordinary address while the alert
+ * line is idle and skipped while it is asserted.
+ *
+ * @param state Per-address probe state of the current scan
+ */
+void smbus_probe_special(uint8_t state[I2C_NUM_ADDRS]);
+
+/**
+ * @brief Read the 3-byte Device ID of every responding device
+ * @param state Per-address probe state of the completed sweep
+ * @return Number of devices that returned a Device ID
+ */
+int i2c_read_device_ids(const uint8_t state[I2C_NUM_ADDRS]);
+
+#endif /* SMBUS_SPECIAL_H_ */
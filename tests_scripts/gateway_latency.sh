@@ -0,0 +1,109 @@
+#!/usr/bin/env bash
+#
+# One I2C scanner and the gateway central on the BabbleSim 2.4 GHz phy.
+#
+# Expects the images built by twister with the bsim harness
+# (sample.i2c_scanner.bsim, sample.i2c_scanner.central.bsim and
+# sample.i2c_scanner.central.reconnect.bsim), which places them in
+# ${BSIM_OUT_PATH}/bin as bs_<board>_i2c_scanner, bs_<board>_i2c_scanner_gateway
+# and bs_<board>_i2c_scanner_gateway_reconnect.
+#
+# The first run keeps the link up. It fails unless the gateway receives scan
+# results both by notification and by GATT read, every notification arrives
+# within LATENCY_LIMIT_US of the sweep completing, and STATS reports at least
+# MIN_BYTES_PER_S of notification throughput. The second run uses the
+# gateway that drops the link every few results (CONFIG_CENTRAL_RECONNECT_AFTER)
+# and fails unless it reconnects at least MIN_RECONNECTS times, each within
+# RECONNECT_LIMIT_US. Latency, throughput and reconnect times are printed.
+
+source ${ZEPHYR_BASE}/tests/bsim/sh_common.source
+
+verbosity_level=2
+EXECUTE_TIMEOUT=${EXECUTE_TIMEOUT:-120}
+SIM_LENGTH=${SIM_LENGTH:-60e6}
+MIN_RESULTS=${MIN_RESULTS:-5}
+LATENCY_LIMIT_US=${LATENCY_LIMIT_US:-500000}
+MIN_BYTES_PER_S=${MIN_BYTES_PER_S:-1}
+MIN_RECONNECTS=${MIN_RECONNECTS:-2}
+RECONNECT_LIMIT_US=${RECONNECT_LIMIT_US:-2000000}
+
+results_dir=${BSIM_OUT_PATH}/results/i2c_scanner_gateway
+mkdir -p ${results_dir}
+
+cd ${BSIM_OUT_PATH}/bin
+
+# run_gateway <run name> <gateway image suffix> <log>
+run_gateway() {
+  local simulation_id="i2c_scanner_gateway_$1"
+
+  Execute ./bs_2G4_phy_v1 -v=${verbosity_level} -s=${simulation_id} -D=2 \
+    -sim_length=${SIM_LENGTH}
+
+  Execute ./bs_${BOARD_TS}_i2c_scanner -v=${verbosity_level} -s=${simulation_id} -d=0
+
+  # The gateway's console output is checked once the simulation has ended
+  timeout ${EXECUTE_TIMEOUT} ./bs_${BOARD_TS}_i2c_scanner_gateway$2 \
+    -v=${verbosity_level} -s=${simulation_id} -d=1 > $3 2>&1 &
+
+  wait_for_background_jobs
+}
+
+gateway_log=${results_dir}/latency.log
+run_gateway latency "" ${gateway_log}
+
+# RESULT,<node>,<bt addr>,<uptime us>,<latency us>,<count>,<flags>,<addrs>
+grep -o 'RESULT,.*' ${gateway_log} | awk -F, \
+  -v min_results=${MIN_RESULTS} -v limit=${LATENCY_LIMIT_US} '
+  $5 >= 0 { n++; sum += $5; if ($5 > max) max = $5 }
+  END {
+    if (n < min_results) {
+      printf "FAIL: %d scan result(s), expected at least %d\n", n, min_results
+      exit 1
+    }
+    printf "%d scan results, latency mean %d us, max %d us\n", n, sum / n, max
+    if (max > limit) {
+      printf "FAIL: latency above %d us\n", limit
+      exit 1
+    }
+  }' || exit 1
+
+if ! grep -q 'READ,' ${gateway_log}; then
+  echo "FAIL: scan result characteristic was never read"
+  exit 1
+fi
+
+# STATS,<uptime us>,<nodes>,<results>,<bytes>,<bytes/s>
+grep -o 'STATS,.*' ${gateway_log} | awk -F, -v min=${MIN_BYTES_PER_S} '
+  { n++; sum += $6 }
+  END {
+    if (n == 0) {
+      print "FAIL: no STATS from the gateway"
+      exit 1
+    }
+    printf "Notification throughput %d bytes/s over %d STATS period(s)\n", sum / n, n
+    if (sum / n < min) {
+      printf "FAIL: throughput below %d bytes/s\n", min
+      exit 1
+    }
+  }' || exit 1
+
+gateway_log=${results_dir}/reconnect.log
+run_gateway reconnect _reconnect ${gateway_log}
+
+# "Node <n> (<addr>) reconnected <us> us after the link dropped"
+grep -o 'reconnected [0-9]* us' ${gateway_log} | awk \
+  -v min_reconnects=${MIN_RECONNECTS} -v limit=${RECONNECT_LIMIT_US} '
+  { n++; sum += $2; if ($2 > max) max = $2 }
+  END {
+    if (n < min_reconnects) {
+      printf "FAIL: %d reconnect(s), expected at least %d\n", n, min_reconnects
+      exit 1
+    }
+    printf "%d reconnects, mean %d us, max %d us\n", n, sum / n, max
+    if (max > limit) {
+      printf "FAIL: reconnect time above %d us\n", limit
+      exit 1
+    }
+  }' || exit 1
+
+echo "PASS"
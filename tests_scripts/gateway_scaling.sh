@@ -0,0 +1,80 @@
+#!/usr/bin/env bash
+#
+# Gateway scaling sweep on the BabbleSim 2.4 GHz phy.
+#
+# Runs the gateway central against an increasing number of I2C scanners
+# (NODE_COUNTS, up to CONFIG_BT_MAX_CONN of the gateway) and reads its STATS
+# lines. The first STATS period is skipped as connection setup. A node count
+# drops when any later STATS line shows fewer nodes connected than started,
+# or when the results per node fall below RATE_FRACTION of those of the
+# smallest node count. The table of all counts and the first one dropping
+# are printed.
+#
+# Expects the images built by twister with the bsim harness
+# (sample.i2c_scanner.bsim and sample.i2c_scanner.central.bsim).
+
+source ${ZEPHYR_BASE}/tests/bsim/sh_common.source
+
+verbosity_level=2
+EXECUTE_TIMEOUT=${EXECUTE_TIMEOUT:-300}
+SIM_LENGTH=${SIM_LENGTH:-120e6}
+NODE_COUNTS=${NODE_COUNTS:-"1 2 4 6 8"}
+RATE_FRACTION=${RATE_FRACTION:-0.9}
+
+results_dir=${BSIM_OUT_PATH}/results/i2c_scanner_gateway_scaling
+mkdir -p ${results_dir}
+
+cd ${BSIM_OUT_PATH}/bin
+
+base_rate=
+first_drop=
+
+printf "%6s %10s %14s %10s\n" nodes min_nodes results/node bytes/s
+for n in ${NODE_COUNTS}; do
+  simulation_id="i2c_scanner_gateway_scaling_${n}"
+  gateway_log=${results_dir}/${n}_nodes.log
+
+  Execute ./bs_2G4_phy_v1 -v=${verbosity_level} -s=${simulation_id} -D=$((n + 1)) \
+    -sim_length=${SIM_LENGTH}
+
+  for d in $(seq 0 $((n - 1))); do
+    Execute ./bs_${BOARD_TS}_i2c_scanner -v=${verbosity_level} -s=${simulation_id} -d=${d}
+  done
+
+  timeout ${EXECUTE_TIMEOUT} ./bs_${BOARD_TS}_i2c_scanner_gateway \
+    -v=${verbosity_level} -s=${simulation_id} -d=${n} > ${gateway_log} 2>&1 &
+
+  wait_for_background_jobs
+
+  # STATS,<uptime us>,<nodes>,<results>,<bytes>,<bytes/s>
+  read min_nodes rate bytes_per_s < <(grep -o 'STATS,.*' ${gateway_log} | awk -F, \
+    -v n=${n} '
+    NR == 1 { next }
+    { p++; results += $4; bps += $6; if (min == "" || $3 < min) min = $3 }
+    END {
+      if (p == 0) { print "0 0 0"; exit }
+      printf "%d %.2f %d\n", min, results / (n * p), bps / p
+    }')
+
+  printf "%6d %10d %14s %10d\n" ${n} ${min_nodes} ${rate} ${bytes_per_s}
+
+  if [ -z "${base_rate}" ]; then
+    base_rate=${rate}
+    if [ "${min_nodes}" -eq 0 ]; then
+      echo "FAIL: no STATS from the gateway, see ${gateway_log}"
+      exit 1
+    fi
+  fi
+
+  if [ -z "${first_drop}" ] && { [ "${min_nodes}" -lt "${n}" ] ||
+     awk -v r=${rate} -v b=${base_rate} -v f=${RATE_FRACTION} \
+       'BEGIN { exit !(r < b * f) }'; }; then
+    first_drop=${n}
+  fi
+done
+
+if [ -n "${first_drop}" ]; then
+  echo "STATS shows drops from ${first_drop} nodes"
+else
+  echo "No drops up to $(echo ${NODE_COUNTS} | awk '{ print $NF }') nodes"
+fi
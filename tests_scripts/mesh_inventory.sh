@@ -0,0 +1,80 @@
+#!/usr/bin/env bash
+#
+# Mesh inventory on the BabbleSim 2.4 GHz phy: NODES self-provisioned
+# scanners and one sink.
+#
+# Each device keeps its flash in a file, and the network runs twice. The
+# first run starts from erased flash: every node provisions itself and the
+# sink must hear from exactly those. The second run reuses the flash: every
+# device must restore its mesh configuration from settings instead of
+# provisioning again, and the sink must hear from all nodes again.
+#
+# Expects the images built by twister with the bsim harness
+# (sample.i2c_scanner.mesh.bsim and sample.i2c_scanner.mesh_sink.bsim).
+
+source ${ZEPHYR_BASE}/tests/bsim/sh_common.source
+
+verbosity_level=2
+EXECUTE_TIMEOUT=${EXECUTE_TIMEOUT:-180}
+SIM_LENGTH=${SIM_LENGTH:-60e6}
+NODES=${NODES:-3}
+
+results_dir=${BSIM_OUT_PATH}/results/i2c_scanner_mesh
+mkdir -p ${results_dir}
+
+cd ${BSIM_OUT_PATH}/bin
+
+# run_network <run> [flash options]
+run_network() {
+  local run=$1
+  local simulation_id="i2c_scanner_mesh_${run}"
+  shift
+
+  Execute ./bs_2G4_phy_v1 -v=${verbosity_level} -s=${simulation_id} -D=$((NODES + 1)) \
+    -sim_length=${SIM_LENGTH}
+
+  for d in $(seq 0 $((NODES - 1))); do
+    timeout ${EXECUTE_TIMEOUT} ./bs_${BOARD_TS}_i2c_scanner_mesh \
+      -v=${verbosity_level} -s=${simulation_id} -d=${d} \
+      -flash_file=${results_dir}/flash_${d}.bin "$@" \
+      > ${results_dir}/${run}_node_${d}.log 2>&1 &
+  done
+
+  timeout ${EXECUTE_TIMEOUT} ./bs_${BOARD_TS}_i2c_scanner_mesh_sink \
+    -v=${verbosity_level} -s=${simulation_id} -d=${NODES} \
+    -flash_file=${results_dir}/flash_${NODES}.bin "$@" \
+    > ${results_dir}/${run}_sink.log 2>&1 &
+
+  wait_for_background_jobs
+}
+
+# check_sink <run>: the sink logs "Mesh node 0x<addr> #<seq>: ..." per message
+# from another node, so exactly NODES distinct addresses must show up
+check_sink() {
+  local heard=$(grep -o 'Mesh node 0x[0-9A-F]*' ${results_dir}/$1_sink.log | sort -u | wc -l)
+
+  echo "$1: sink heard from ${heard} of ${NODES} node(s)"
+  if [ ${heard} -ne ${NODES} ]; then
+    echo "FAIL: $1 run expected ${NODES} nodes, see ${results_dir}/$1_sink.log"
+    exit 1
+  fi
+}
+
+run_network first -flash_erase
+check_sink first
+if [ $(grep -l 'Mesh self-provisioned as' ${results_dir}/first_*.log | wc -l) -ne $((NODES + 1)) ]; then
+  echo "FAIL: not every device provisioned itself on the first run"
+  exit 1
+fi
+
+run_network second
+check_sink second
+for log in ${results_dir}/second_*.log; do
+  if ! grep -q 'Mesh configuration restored' ${log} ||
+     grep -q 'Mesh self-provisioned as' ${log}; then
+    echo "FAIL: ${log} did not restore its mesh configuration"
+    exit 1
+  fi
+done
+
+echo "PASS"